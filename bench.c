@@ -0,0 +1,363 @@
+/*
+ *  File Check Daemon - ficheda_bench, замеры производительности
+ *
+ *  Usage: ficheda_bench [-d dir] [-s scale] [-r repeat] [-t threads] [-n concurrency] [-O order] [-a algorithm]
+ *                       [-m read] [-b benches]
+ *
+ *  - dir - каталог для синтетических миссий (по умолчанию /dev/shm/ficheda_bench, tmpfs)
+ *  - scale - число файлов в наборах в % от полного (по умолчанию 100)
+ *  - repeat - сканирований каждого вида (по умолчанию 10)
+ *  - threads, concurrency, order, algorithm, read - как у ficheda (0 и auto - по устройству dir)
+ *  - benches - через запятую: crc, digest, small, large, mixed (по умолчанию все)
+ *
+ *  Результат - NDJSON в stdout, строка на замер (сравнение между коммитами - diff/jq):
+ *  - crc - ядра CRC-32 и CRC-32C (crc32.c) на буферах от 64 байт до 4 МиБ, GB/s
+ *  - digest - алгоритмы digest.c через fcd_digest->update(), GB/s
+ *  - small (100k x 4 КиБ), large (1k x 100 МиБ), mixed - синтетический каталог миссии:
+ *    первичный расчёт, полное сканирование (deep) в каждом порядке чтения (readdir, inode,
+ *    extent - elevator.c), сканирование без изменений (подпись stat()) и с 1% изменённых
+ *    файлов; files/s, GB/s, p50/p99 длительности сканирования и записи JSON-файла отчёта
+ *
+ *  Сканирование - тот же код, что у демона (mission.c), каждый набор - в дочернем
+ *  процессе (свой пул и эталонный список). Не хватает места в dir - строка с "error".
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "budget.h"
+#include "crc32.h"
+#include "digest.h"
+#include "ficheda.h"
+#include "metrics.h"
+#include "mission.h"
+
+#define BENCH_DIR         "/dev/shm/ficheda_bench"
+#define BENCH_REPEAT      10
+#define BENCH_MICRO_NS    100000000l
+#define BENCH_BUFF_SIZE   (4l * 1048576)
+#define BENCH_GROUPS      3
+
+struct FCD_BENCH_GROUP {
+    long count;
+    long size;
+};
+
+struct FCD_BENCH_SET {
+    const char *name;
+    struct FCD_BENCH_GROUP groups[BENCH_GROUPS];
+};
+
+const struct FCD_BENCH_SET bench_sets[] = {
+  {"small", {{100000, 4096}}},
+  {"large", {{1000, 100l * 1048576}}},
+  {"mixed", {{10000, 4096}, {1000, 1048576}, {10, 100l * 1048576}}},
+  {NULL, {{0, 0}}}
+};
+
+const size_t bench_sizes[] = {64, 256, 1024, 4096, 16384, 65536, 262144, 1048576, 4194304, 0};
+
+char *bench_dir = BENCH_DIR;
+long bench_scale = 100;
+int bench_repeat = BENCH_REPEAT;
+int bench_concurrency = 0;
+int bench_order = FCD_ORDER_AUTO;
+char *bench_list = "crc,digest,small,large,mixed";
+unsigned char *bench_buff = NULL;
+struct FCD_MISSION *bench_mission = NULL;
+
+//  xorshift64 - incompressible, reproducible content
+void bench_fill(unsigned char *_buff, size_t _len, uint64_t _seed) {
+  uint64_t x = _seed * 0x9E3779B97F4A7C15ull | 1;
+  for (size_t i = 0; i + 8 <= _len; i += 8) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    memcpy(_buff + i, &x, 8);
+  }
+}
+
+int bench_selected(const char *_name) {
+  size_t len = strlen(_name);
+  for (const char *p = bench_list; (p = strstr(p, _name)); p += len)
+    if ((p == bench_list || p[-1] == ',') && (p[len] == ',' || p[len] == '\0')) return 1;
+  return 0;
+}
+
+//  nearest-rank percentile of sorted samples, ms
+double bench_percentile(const int64_t *_sorted, int _count, int _percent) {
+  int rank = (_count * _percent + 99) / 100;
+  if (rank < 1) rank = 1;
+  return _sorted[rank - 1] / 1e6;
+}
+
+int bench_cmp_ns(const void *_a, const void *_b) {
+  int64_t a = *(const int64_t *)_a, b = *(const int64_t *)_b;
+  return (a > b) - (a < b);
+}
+
+//  {"bench":"crc",...} per buffer size, the kernel runs at least BENCH_MICRO_NS per size
+void bench_crc(const char *_algorithm, const struct CRC32_KERNEL *_kernels) {
+  for (const struct CRC32_KERNEL *kernel = _kernels; kernel->name; ++kernel) {
+    if (!kernel->supported()) continue;
+    for (const size_t *size = bench_sizes; *size; ++size) {
+      uint32_t crc = CRC_START_32;
+      uint64_t bytes = 0;
+      int64_t start = fcd_clock_ns(CLOCK_MONOTONIC), ns;
+      do {
+        for (size_t offset = 0; offset + *size <= BENCH_BUFF_SIZE; offset += *size)
+          crc = kernel->update(crc, bench_buff + offset, *size);
+        bytes += BENCH_BUFF_SIZE / *size * *size;
+      } while ((ns = fcd_clock_ns(CLOCK_MONOTONIC) - start) < BENCH_MICRO_NS);
+      printf("{\"bench\":\"crc\",\"algorithm\":\"%s\",\"kernel\":\"%s\",\"size\":%lu,\"bytes\":%llu,"
+             "\"seconds\":%.6f,\"gb_s\":%.3f,\"check\":\"0x%08X\"}\n", _algorithm, kernel->name,
+             (unsigned long)*size, (unsigned long long)bytes, ns / 1e9, (double)bytes / ns, crc);
+      fflush(stdout);
+    }
+  }
+}
+
+void bench_digest(void) {
+  union FCD_DIGEST_STATE state;
+  unsigned char value[FCD_DIGEST_MAX];
+  for (const struct FCD_DIGEST *digest = fcd_digests; digest->name; ++digest) {
+    for (const size_t *size = bench_sizes; *size; ++size) {
+      uint64_t bytes = 0;
+      int64_t start = fcd_clock_ns(CLOCK_MONOTONIC), ns;
+      //  a buffer is a file: init, update, final
+      do {
+        for (size_t offset = 0; offset + *size <= BENCH_BUFF_SIZE; offset += *size) {
+          digest->init(&state, 0);
+          digest->update(&state, bench_buff + offset, *size);
+          digest->final(&state, value);
+        }
+        bytes += BENCH_BUFF_SIZE / *size * *size;
+      } while ((ns = fcd_clock_ns(CLOCK_MONOTONIC) - start) < BENCH_MICRO_NS);
+      printf("{\"bench\":\"digest\",\"algorithm\":\"%s\",\"kernel\":\"%s\",\"size\":%lu,\"bytes\":%llu,"
+             "\"seconds\":%.6f,\"gb_s\":%.3f}\n", digest->name, digest->kernel(), (unsigned long)*size,
+             (unsigned long long)bytes, ns / 1e9, (double)bytes / ns);
+      fflush(stdout);
+    }
+  }
+}
+
+long bench_set_count(const struct FCD_BENCH_SET *_set, int _group) {
+  long count = _set->groups[_group].count * bench_scale / 100;
+  if (!_set->groups[_group].count) return 0;
+  return count < 1 ? 1 : count;
+}
+
+void bench_name(char *_name, int _group, long _n) {
+  sprintf(_name, "g%d_%07ld.data", _group, _n);
+}
+
+//  write the files of the set into the current directory
+int bench_generate(const struct FCD_BENCH_SET *_set) {
+  char name[64];
+  for (int g = 0; g < BENCH_GROUPS; ++g) {
+    for (long n = 0; n < bench_set_count(_set, g); ++n) {
+      bench_name(name, g, n);
+      int fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+      if (fd < 0) return errno;
+      for (long left = _set->groups[g].size; left > 0;) {
+        size_t len = left < BENCH_BUFF_SIZE ? left : BENCH_BUFF_SIZE;
+        bench_fill(bench_buff, len, ((uint64_t)g << 40) + n * 131 + left);
+        if (write(fd, bench_buff, len) != (ssize_t)len) {
+          int cc = errno;
+          close(fd);
+          return cc ? cc : EIO;
+        }
+        left -= len;
+      }
+      if (close(fd)) return errno;
+    }
+  }
+  return 0;
+}
+
+void bench_remove(const struct FCD_BENCH_SET *_set) {
+  char name[64];
+  for (int g = 0; g < BENCH_GROUPS; ++g) {
+    for (long n = 0; n < bench_set_count(_set, g); ++n) {
+      bench_name(name, g, n);
+      unlink(name);
+    }
+  }
+}
+
+//  rewrite the head of every 100th file (a different 1% each round)
+void bench_change(const struct FCD_BENCH_SET *_set, int _round) {
+  char name[64];
+  for (int g = 0; g < BENCH_GROUPS; ++g) {
+    long count = bench_set_count(_set, g);
+    for (long n = _round % 100; n < count; n += 100) {
+      bench_name(name, g, n);
+      int fd = open(name, O_WRONLY);
+      if (fd < 0) severe_error_0("open(bench)", errno);
+      size_t len = _set->groups[g].size < 4096 ? _set->groups[g].size : 4096;
+      bench_fill(bench_buff, len, fcd_clock_ns(CLOCK_REALTIME));
+      if (pwrite(fd, bench_buff, len, 0) != (ssize_t)len) severe_error_0("pwrite(bench)", errno);
+      close(fd);
+    }
+  }
+}
+
+//  _deep: 1 - content of all files, 0 - stat() signature; _change - 1% changed before each scan
+void bench_scans(const struct FCD_BENCH_SET *_set, const char *_kind, struct FCD_JSON *_json, int _repeat,
+                 int _deep, int _change) {
+  int64_t scan_ns[_repeat], report_ns[_repeat], total = 0;
+  uint64_t files = fcd_metrics_total(FCD_METRICS_FILES_CONTENT), bytes = fcd_metrics_total(FCD_METRICS_BYTES);
+  for (int r = 0; r < _repeat; ++r) {
+    if (_change) bench_change(_set, r);
+    bench_mission->scan_deep = _deep;
+    int64_t start = fcd_clock_ns(CLOCK_MONOTONIC);
+    thread_calculators_launcher_scan(bench_mission, 1, NULL, 0);
+    scan_ns[r] = fcd_clock_ns(CLOCK_MONOTONIC) - start;
+    total += scan_ns[r];
+    //  JSON-writer work, here in the same thread
+    struct FCD_REPORT *report = fcd_results_take(&bench_mission->results);
+    start = fcd_clock_ns(CLOCK_MONOTONIC);
+    if (report->full) thread_json_writer_full(bench_mission, _json, report);
+    report_ns[r] = fcd_clock_ns(CLOCK_MONOTONIC) - start;
+    fcd_results_release(&bench_mission->results, report);
+  }
+  files = fcd_metrics_total(FCD_METRICS_FILES_CONTENT) - files;
+  bytes = fcd_metrics_total(FCD_METRICS_BYTES) - bytes;
+  qsort(scan_ns, _repeat, sizeof(int64_t), bench_cmp_ns);
+  qsort(report_ns, _repeat, sizeof(int64_t), bench_cmp_ns);
+  printf("{\"bench\":\"scan\",\"dataset\":\"%s\",\"scan\":\"%s\",\"algorithm\":\"%s\",\"read\":\"%s\",\"threads\":%d,"
+         "\"concurrency\":%d,\"order\":\"%s\",\"files\":%lu,\"repeat\":%d,\"files_read\":%llu,\"bytes_read\":%llu,\"files_s\":%.1f,\"gb_s\":%.3f,"
+         "\"p50_ms\":%.3f,\"p99_ms\":%.3f,\"report_p50_ms\":%.3f,\"report_p99_ms\":%.3f}\n",
+         _set->name, _kind, fcd_digest->name, fcd_read_mode_names[mission_read], mission_threads, bench_mission->level,
+         fcd_order_names[bench_mission->order_mode], (unsigned long)bench_mission->etalon.count, _repeat, (unsigned long long)files, (unsigned long long)bytes,
+         total > 0 ? bench_mission->etalon.count * (double)_repeat * 1e9 / total : 0.0, total > 0 ? (double)bytes / total : 0.0,
+         bench_percentile(scan_ns, _repeat, 50), bench_percentile(scan_ns, _repeat, 99),
+         bench_percentile(report_ns, _repeat, 50), bench_percentile(report_ns, _repeat, 99));
+  fflush(stdout);
+}
+
+//  the child process: one synthetic mission, its own pool and etalon list
+_Noreturn void bench_set(const struct FCD_BENCH_SET *_set) {
+  char path[PATH_MAX], json[PATH_MAX];
+  struct FCD_JSON out;
+  struct statvfs vfs;
+  uint64_t need = 0;
+  for (int g = 0; g < BENCH_GROUPS; ++g) need += (uint64_t)bench_set_count(_set, g) * _set->groups[g].size;
+  snprintf(path, sizeof(path), "%s/%s", bench_dir, _set->name);
+  snprintf(json, sizeof(json), "%s/%s.json", bench_dir, _set->name);
+  if (statvfs(bench_dir, &vfs) == 0 && (uint64_t)vfs.f_bavail * vfs.f_frsize < need + need / 16) {
+    printf("{\"bench\":\"scan\",\"dataset\":\"%s\",\"error\":\"not enough space in %s: %llu bytes needed\"}\n",
+           _set->name, bench_dir, (unsigned long long)need);
+    exit(EXIT_SUCCESS);
+  }
+  if (mkdir(path, 0700) && errno != EEXIST) severe_error_0("mkdir(bench)", errno);
+  if (chdir(path)) severe_error_0("chdir(bench)", errno);
+  int cc = bench_generate(_set);
+  if (cc) {
+    bench_remove(_set);
+    printf("{\"bench\":\"scan\",\"dataset\":\"%s\",\"error\":\"%s\"}\n", _set->name, strerror(cc));
+    exit(EXIT_SUCCESS);
+  }
+  //  the mission before the pool - threads=0 sizes it for the device of the mission
+  bench_mission = fcd_mission_new();
+  bench_mission->path = bench_mission->name = path;
+  bench_mission->json = json;
+  bench_mission->concurrency = bench_concurrency;
+  bench_mission->order = bench_order;
+  fcd_mission_init();
+  fcd_mission_start(bench_mission);
+  fcd_json_init(&out, bench_mission->json, ".tmp");
+  //  the etalon list - the initial calculation
+  int64_t start = fcd_clock_ns(CLOCK_MONOTONIC);
+  thread_calculators_launcher_initial(bench_mission);
+  int64_t initial_ns = fcd_clock_ns(CLOCK_MONOTONIC) - start;
+  printf("{\"bench\":\"scan\",\"dataset\":\"%s\",\"scan\":\"initial\",\"algorithm\":\"%s\",\"read\":\"%s\","
+         "\"threads\":%d,\"concurrency\":%d,\"files\":%lu,\"bytes\":%llu,\"files_s\":%.1f,\"gb_s\":%.3f,\"ms\":%.3f,"
+         "\"etalon_bytes_per_file\":%.1f}\n",
+         _set->name, fcd_digest->name, fcd_read_mode_names[mission_read], mission_threads, bench_mission->level,
+         (unsigned long)bench_mission->etalon.count, (unsigned long long)need,
+         bench_mission->etalon.count * 1e9 / initial_ns,
+         (double)need / initial_ns, initial_ns / 1e6,
+         (double)fcd_etalon_bytes(&bench_mission->etalon) / bench_mission->etalon.count);
+  fflush(stdout);
+  //  the deep scan in every order of reading - readdir against the elevator
+  int order = bench_mission->order_mode;
+  for (int mode = FCD_ORDER_READDIR; mode <= FCD_ORDER_EXTENT; ++mode) {
+    bench_mission->order_mode = mode;
+    bench_scans(_set, "full", &out, bench_repeat, 1, 0);
+  }
+  //  the extent run ends in inode order if dir has no FIEMAP
+  if (order != FCD_ORDER_EXTENT) bench_mission->order_mode = order;
+  bench_scans(_set, "unchanged", &out, bench_repeat, 0, 0);
+  bench_scans(_set, "changed", &out, bench_repeat, 0, 1);
+  bench_remove(_set);
+  unlink(json);
+  if (chdir(bench_dir) == 0) rmdir(path);
+  exit(EXIT_SUCCESS);
+}
+
+void bench_usage(void) {
+  fprintf(stderr, "Usage: ficheda_bench [-d dir] [-s scale] [-r repeat] [-t threads] [-n concurrency] [-O order] "
+                  "[-a algorithm] [-m read] [-b benches]\n");
+  exit(EXIT_FAILURE);
+}
+
+int main(int _argc, char* _argv[]) {
+  int opt, mode;
+  while ((opt = getopt(_argc, _argv, "d:s:r:t:n:O:a:m:b:")) != -1) {
+    switch (opt) {
+      case 'd': bench_dir = optarg; break;
+      case 's': bench_scale = atol(optarg); break;
+      case 'r': bench_repeat = atoi(optarg); break;
+      case 't': mission_threads = atoi(optarg); break;
+      case 'n': bench_concurrency = atoi(optarg); break;
+      case 'O':
+        for (bench_order = 0; fcd_order_names[bench_order]; ++bench_order)
+          if (strcmp(fcd_order_names[bench_order], optarg) == 0) break;
+        if (!fcd_order_names[bench_order]) bench_usage();
+        break;
+      case 'a': if (fcd_digest_select(optarg)) bench_usage(); break;
+      case 'm':
+        if ((mode = fcd_read_mode(optarg)) < 0) bench_usage();
+        mission_read = mode;
+        break;
+      case 'b': bench_list = optarg; break;
+      default: bench_usage();
+    }
+  }
+  if (bench_scale < 1 || bench_repeat < 1 || mission_threads < 0 || bench_concurrency < 0) bench_usage();
+  //  errors to stderr, the integrity messages of the changed files are not needed
+  openlog("ficheda_bench", LOG_PID | LOG_PERROR, LOG_USER);
+  setlogmask(LOG_UPTO(LOG_ERR));
+  crc32_init();
+  bench_buff = my_malloc(BENCH_BUFF_SIZE);
+  bench_fill(bench_buff, BENCH_BUFF_SIZE, 1);
+  if (bench_selected("crc")) {
+    bench_crc("crc32", crc32_kernels);
+    bench_crc("crc32c", crc32c_kernels);
+  }
+  if (bench_selected("digest")) bench_digest();
+  if (mkdir(bench_dir, 0700) && errno != EEXIST) severe_error_0("mkdir(bench_dir)", errno);
+  for (const struct FCD_BENCH_SET *set = bench_sets; set->name; ++set) {
+    if (!bench_selected(set->name)) continue;
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) severe_error_0("fork()", errno);
+    if (pid == 0) bench_set(set);
+    int status;
+    if (waitpid(pid, &status, 0) < 0) severe_error_0("waitpid()", errno);
+    if (!WIFEXITED(status) || WEXITSTATUS(status))
+      printf("{\"bench\":\"scan\",\"dataset\":\"%s\",\"error\":\"status %d\"}\n", set->name, status);
+  }
+  rmdir(bench_dir);
+  return 0;
+}
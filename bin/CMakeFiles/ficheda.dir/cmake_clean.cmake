@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ficheda.dir/main.c.o"
+  "CMakeFiles/ficheda.dir/main.c.o.d"
+  "ficheda"
+  "ficheda.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/ficheda.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
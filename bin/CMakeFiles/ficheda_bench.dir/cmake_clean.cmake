@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ficheda_bench.dir/bench.c.o"
+  "CMakeFiles/ficheda_bench.dir/bench.c.o.d"
+  "ficheda_bench"
+  "ficheda_bench.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/ficheda_bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
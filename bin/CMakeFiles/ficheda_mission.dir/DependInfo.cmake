@@ -0,0 +1,38 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/blake3.c" "CMakeFiles/ficheda_mission.dir/blake3.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/blake3.c.o.d"
+  "/root/repo/budget.c" "CMakeFiles/ficheda_mission.dir/budget.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/budget.c.o.d"
+  "/root/repo/control.c" "CMakeFiles/ficheda_mission.dir/control.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/control.c.o.d"
+  "/root/repo/crc32.c" "CMakeFiles/ficheda_mission.dir/crc32.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/crc32.c.o.d"
+  "/root/repo/device.c" "CMakeFiles/ficheda_mission.dir/device.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/device.c.o.d"
+  "/root/repo/digest.c" "CMakeFiles/ficheda_mission.dir/digest.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/digest.c.o.d"
+  "/root/repo/elevator.c" "CMakeFiles/ficheda_mission.dir/elevator.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/elevator.c.o.d"
+  "/root/repo/etadb.c" "CMakeFiles/ficheda_mission.dir/etadb.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/etadb.c.o.d"
+  "/root/repo/etalon.c" "CMakeFiles/ficheda_mission.dir/etalon.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/etalon.c.o.d"
+  "/root/repo/ficheda.c" "CMakeFiles/ficheda_mission.dir/ficheda.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/ficheda.c.o.d"
+  "/root/repo/json.c" "CMakeFiles/ficheda_mission.dir/json.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/json.c.o.d"
+  "/root/repo/metrics.c" "CMakeFiles/ficheda_mission.dir/metrics.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/metrics.c.o.d"
+  "/root/repo/mission.c" "CMakeFiles/ficheda_mission.dir/mission.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/mission.c.o.d"
+  "/root/repo/pool.c" "CMakeFiles/ficheda_mission.dir/pool.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/pool.c.o.d"
+  "/root/repo/reader.c" "CMakeFiles/ficheda_mission.dir/reader.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/reader.c.o.d"
+  "/root/repo/results.c" "CMakeFiles/ficheda_mission.dir/results.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/results.c.o.d"
+  "/root/repo/rolling.c" "CMakeFiles/ficheda_mission.dir/rolling.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/rolling.c.o.d"
+  "/root/repo/tree.c" "CMakeFiles/ficheda_mission.dir/tree.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/tree.c.o.d"
+  "/root/repo/uring.c" "CMakeFiles/ficheda_mission.dir/uring.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/uring.c.o.d"
+  "/root/repo/xxh3.c" "CMakeFiles/ficheda_mission.dir/xxh3.c.o" "gcc" "CMakeFiles/ficheda_mission.dir/xxh3.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,47 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ficheda_mission.dir/blake3.c.o"
+  "CMakeFiles/ficheda_mission.dir/blake3.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/budget.c.o"
+  "CMakeFiles/ficheda_mission.dir/budget.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/control.c.o"
+  "CMakeFiles/ficheda_mission.dir/control.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/crc32.c.o"
+  "CMakeFiles/ficheda_mission.dir/crc32.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/device.c.o"
+  "CMakeFiles/ficheda_mission.dir/device.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/digest.c.o"
+  "CMakeFiles/ficheda_mission.dir/digest.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/elevator.c.o"
+  "CMakeFiles/ficheda_mission.dir/elevator.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/etadb.c.o"
+  "CMakeFiles/ficheda_mission.dir/etadb.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/etalon.c.o"
+  "CMakeFiles/ficheda_mission.dir/etalon.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/ficheda.c.o"
+  "CMakeFiles/ficheda_mission.dir/ficheda.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/json.c.o"
+  "CMakeFiles/ficheda_mission.dir/json.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/metrics.c.o"
+  "CMakeFiles/ficheda_mission.dir/metrics.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/mission.c.o"
+  "CMakeFiles/ficheda_mission.dir/mission.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/pool.c.o"
+  "CMakeFiles/ficheda_mission.dir/pool.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/reader.c.o"
+  "CMakeFiles/ficheda_mission.dir/reader.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/results.c.o"
+  "CMakeFiles/ficheda_mission.dir/results.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/rolling.c.o"
+  "CMakeFiles/ficheda_mission.dir/rolling.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/tree.c.o"
+  "CMakeFiles/ficheda_mission.dir/tree.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/uring.c.o"
+  "CMakeFiles/ficheda_mission.dir/uring.c.o.d"
+  "CMakeFiles/ficheda_mission.dir/xxh3.c.o"
+  "CMakeFiles/ficheda_mission.dir/xxh3.c.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/ficheda_mission.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
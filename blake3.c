@@ -0,0 +1,275 @@
+/*
+ *  File Check Daemon - BLAKE3-256
+ *
+ *  Переносимая реализация функции сжатия (7 раундов по 8 вызовов G) на
+ *  32-битных словах; параллельность - не SIMD по кускам, а части файла в
+ *  пуле потоков (blake3_hasher_init_at / blake3_merge_subtrees).
+ */
+#include <string.h>
+#include "blake3.h"
+
+#define BLAKE3_CHUNK_START    1
+#define BLAKE3_CHUNK_END      2
+#define BLAKE3_PARENT         4
+#define BLAKE3_ROOT           8
+
+struct BLAKE3_OUTPUT {
+    uint32_t cv[8];
+    uint32_t block[16];
+    uint64_t counter;
+    uint32_t block_len;
+    uint32_t flags;
+};
+
+static const uint32_t blake3_iv[8] = {
+  0x6A09E667ul, 0xBB67AE85ul, 0x3C6EF372ul, 0xA54FF53Aul, 0x510E527Ful, 0x9B05688Cul, 0x1F83D9ABul, 0x5BE0CD19ul
+};
+
+static const uint8_t blake3_schedule[7][16] = {
+  {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+  {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8},
+  {3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1},
+  {10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6},
+  {12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4},
+  {9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7},
+  {11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13}
+};
+
+static inline uint32_t blake3_rotr(uint32_t _x, int _r) {
+  return (_x >> _r) | (_x << (32 - _r));
+}
+
+static inline uint32_t blake3_load32(const unsigned char *_p) {
+  return (uint32_t)_p[0] | ((uint32_t)_p[1] << 8) | ((uint32_t)_p[2] << 16) | ((uint32_t)_p[3] << 24);
+}
+
+static inline void blake3_store32(unsigned char *_p, uint32_t _w) {
+  _p[0] = _w;
+  _p[1] = _w >> 8;
+  _p[2] = _w >> 16;
+  _p[3] = _w >> 24;
+}
+
+#define BLAKE3_G(a, b, c, d, x, y)                                         \
+  do {                                                                     \
+    s[a] = s[a] + s[b] + (x); s[d] = blake3_rotr(s[d] ^ s[a], 16);         \
+    s[c] = s[c] + s[d];       s[b] = blake3_rotr(s[b] ^ s[c], 12);         \
+    s[a] = s[a] + s[b] + (y); s[d] = blake3_rotr(s[d] ^ s[a], 8);          \
+    s[c] = s[c] + s[d];       s[b] = blake3_rotr(s[b] ^ s[c], 7);          \
+  } while (0)
+
+//  the first 8 words of the compression output - the chaining value
+static void blake3_compress(const uint32_t *_cv, const uint32_t *_m, uint64_t _counter, uint32_t _block_len,
+                            uint32_t _flags, uint32_t *_out) {
+  uint32_t s[16] = {
+    _cv[0], _cv[1], _cv[2], _cv[3], _cv[4], _cv[5], _cv[6], _cv[7],
+    blake3_iv[0], blake3_iv[1], blake3_iv[2], blake3_iv[3],
+    (uint32_t)_counter, (uint32_t)(_counter >> 32), _block_len, _flags
+  };
+  for (int r = 0; r < 7; ++r) {
+    const uint8_t *p = blake3_schedule[r];
+    BLAKE3_G(0, 4, 8, 12, _m[p[0]], _m[p[1]]);
+    BLAKE3_G(1, 5, 9, 13, _m[p[2]], _m[p[3]]);
+    BLAKE3_G(2, 6, 10, 14, _m[p[4]], _m[p[5]]);
+    BLAKE3_G(3, 7, 11, 15, _m[p[6]], _m[p[7]]);
+    BLAKE3_G(0, 5, 10, 15, _m[p[8]], _m[p[9]]);
+    BLAKE3_G(1, 6, 11, 12, _m[p[10]], _m[p[11]]);
+    BLAKE3_G(2, 7, 8, 13, _m[p[12]], _m[p[13]]);
+    BLAKE3_G(3, 4, 9, 14, _m[p[14]], _m[p[15]]);
+  }
+  for (int i = 0; i < 8; ++i) _out[i] = s[i] ^ s[i + 8];
+}
+
+static void blake3_words(const unsigned char *_block, uint32_t *_m) {
+  for (int i = 0; i < 16; ++i) _m[i] = blake3_load32(_block + 4 * i);
+}
+
+static void blake3_output_cv(const struct BLAKE3_OUTPUT *_output, uint32_t *_cv) {
+  blake3_compress(_output->cv, _output->block, _output->counter, _output->block_len, _output->flags, _cv);
+}
+
+static void blake3_output_parent(const uint32_t *_left, const uint32_t *_right, struct BLAKE3_OUTPUT *_output) {
+  memcpy(_output->cv, blake3_iv, sizeof(blake3_iv));
+  memcpy(_output->block, _left, 32);
+  memcpy(_output->block + 8, _right, 32);
+  _output->counter = 0;
+  _output->block_len = BLAKE3_BLOCK_LEN;
+  _output->flags = BLAKE3_PARENT;
+}
+
+static void blake3_output_root(const struct BLAKE3_OUTPUT *_output, unsigned char *_out) {
+  uint32_t cv[8];
+  blake3_compress(_output->cv, _output->block, 0, _output->block_len, _output->flags | BLAKE3_ROOT, cv);
+  for (int i = 0; i < 8; ++i) blake3_store32(_out + 4 * i, cv[i]);
+}
+
+static void blake3_chunk_init(struct BLAKE3_CHUNK *_chunk, uint64_t _counter) {
+  memcpy(_chunk->cv, blake3_iv, sizeof(blake3_iv));
+  _chunk->counter = _counter;
+  _chunk->block_len = 0;
+  _chunk->blocks_compressed = 0;
+}
+
+static size_t blake3_chunk_len(const struct BLAKE3_CHUNK *_chunk) {
+  return (size_t)_chunk->blocks_compressed * BLAKE3_BLOCK_LEN + _chunk->block_len;
+}
+
+static uint32_t blake3_chunk_start(const struct BLAKE3_CHUNK *_chunk) {
+  return _chunk->blocks_compressed ? 0 : BLAKE3_CHUNK_START;
+}
+
+static void blake3_chunk_update(struct BLAKE3_CHUNK *_chunk, const unsigned char *_in, size_t _len) {
+  uint32_t m[16];
+  while (_len) {
+    //  the full block is compressed only when more input follows (the last one gets CHUNK_END)
+    if (_chunk->block_len == BLAKE3_BLOCK_LEN) {
+      blake3_words(_chunk->block, m);
+      blake3_compress(_chunk->cv, m, _chunk->counter, BLAKE3_BLOCK_LEN, blake3_chunk_start(_chunk), _chunk->cv);
+      ++_chunk->blocks_compressed;
+      _chunk->block_len = 0;
+    }
+    //  whole blocks straight from the input
+    if (!_chunk->block_len) {
+      for (; _len > BLAKE3_BLOCK_LEN; _in += BLAKE3_BLOCK_LEN, _len -= BLAKE3_BLOCK_LEN) {
+        blake3_words(_in, m);
+        blake3_compress(_chunk->cv, m, _chunk->counter, BLAKE3_BLOCK_LEN, blake3_chunk_start(_chunk), _chunk->cv);
+        ++_chunk->blocks_compressed;
+      }
+    }
+    size_t take = BLAKE3_BLOCK_LEN - _chunk->block_len;
+    if (take > _len) take = _len;
+    memcpy(_chunk->block + _chunk->block_len, _in, take);
+    _chunk->block_len += take;
+    _in += take;
+    _len -= take;
+  }
+}
+
+static void blake3_chunk_output(const struct BLAKE3_CHUNK *_chunk, struct BLAKE3_OUTPUT *_output) {
+  unsigned char block[BLAKE3_BLOCK_LEN];
+  memcpy(block, _chunk->block, _chunk->block_len);
+  memset(block + _chunk->block_len, 0, BLAKE3_BLOCK_LEN - _chunk->block_len);
+  memcpy(_output->cv, _chunk->cv, sizeof(_chunk->cv));
+  blake3_words(block, _output->block);
+  _output->counter = _chunk->counter;
+  _output->block_len = _chunk->block_len;
+  _output->flags = blake3_chunk_start(_chunk) | BLAKE3_CHUNK_END;
+}
+
+static void blake3_stack_cv(const struct BLAKE3_HASHER *_hasher, int _n, uint32_t *_cv) {
+  for (int i = 0; i < 8; ++i) _cv[i] = blake3_load32(_hasher->cv_stack + _n * BLAKE3_OUT_LEN + 4 * i);
+}
+
+//  the chunk count decides how many subtrees are complete (merged lazily, the last one may be the root)
+static void blake3_push_cv(struct BLAKE3_HASHER *_hasher, uint32_t *_cv, uint64_t _chunks) {
+  struct BLAKE3_OUTPUT output;
+  uint32_t left[8];
+  for (; (_chunks & 1) == 0; _chunks >>= 1) {
+    blake3_stack_cv(_hasher, --_hasher->cv_stack_len, left);
+    blake3_output_parent(left, _cv, &output);
+    blake3_output_cv(&output, _cv);
+  }
+  for (int i = 0; i < 8; ++i) blake3_store32(_hasher->cv_stack + _hasher->cv_stack_len * BLAKE3_OUT_LEN + 4 * i, _cv[i]);
+  ++_hasher->cv_stack_len;
+}
+
+void blake3_hasher_init(struct BLAKE3_HASHER *_hasher) {
+  blake3_hasher_init_at(_hasher, 0);
+}
+
+//  a part of the input that starts with chunk number _chunk
+void blake3_hasher_init_at(struct BLAKE3_HASHER *_hasher, uint64_t _chunk) {
+  blake3_chunk_init(&_hasher->chunk, _chunk);
+  _hasher->chunks = 0;
+  _hasher->cv_stack_len = 0;
+}
+
+void blake3_hasher_update(struct BLAKE3_HASHER *_hasher, const void *_buf, size_t _len) {
+  const unsigned char *in = _buf;
+  struct BLAKE3_OUTPUT output;
+  uint32_t cv[8];
+  while (_len) {
+    //  the full chunk goes to the tree only when more input follows
+    if (blake3_chunk_len(&_hasher->chunk) == BLAKE3_CHUNK_LEN) {
+      blake3_chunk_output(&_hasher->chunk, &output);
+      blake3_output_cv(&output, cv);
+      blake3_push_cv(_hasher, cv, ++_hasher->chunks);
+      blake3_chunk_init(&_hasher->chunk, _hasher->chunk.counter + 1);
+    }
+    size_t take = BLAKE3_CHUNK_LEN - blake3_chunk_len(&_hasher->chunk);
+    if (take > _len) take = _len;
+    blake3_chunk_update(&_hasher->chunk, in, take);
+    in += take;
+    _len -= take;
+  }
+}
+
+//  the current chunk and the stack folded right to left
+static void blake3_hasher_output(const struct BLAKE3_HASHER *_hasher, struct BLAKE3_OUTPUT *_output) {
+  uint32_t left[8], right[8];
+  blake3_chunk_output(&_hasher->chunk, _output);
+  for (int n = _hasher->cv_stack_len - 1; n >= 0; --n) {
+    blake3_output_cv(_output, right);
+    blake3_stack_cv(_hasher, n, left);
+    blake3_output_parent(left, right, _output);
+  }
+}
+
+void blake3_hasher_finalize(const struct BLAKE3_HASHER *_hasher, unsigned char *_out) {
+  struct BLAKE3_OUTPUT output;
+  blake3_hasher_output(_hasher, &output);
+  blake3_output_root(&output, _out);
+}
+
+//  the chaining value of the part (never the root)
+void blake3_hasher_subtree(const struct BLAKE3_HASHER *_hasher, unsigned char *_cv) {
+  struct BLAKE3_OUTPUT output;
+  uint32_t cv[8];
+  blake3_hasher_output(_hasher, &output);
+  blake3_output_cv(&output, cv);
+  for (int i = 0; i < 8; ++i) blake3_store32(_cv + 4 * i, cv[i]);
+}
+
+//  the left subtree of n chunks holds the largest power of 2 chunks less than n
+static uint64_t blake3_left_chunks(uint64_t _chunks) {
+  uint64_t left = 1;
+  while (left * 2 < _chunks) left *= 2;
+  return left;
+}
+
+static void blake3_merge_output(const unsigned char *_cvs, size_t _stride, int _count, uint64_t _part_chunks,
+                                uint64_t _chunks, struct BLAKE3_OUTPUT *_output) {
+  uint32_t left[8], right[8];
+  struct BLAKE3_OUTPUT child;
+  uint64_t left_chunks = blake3_left_chunks(_chunks);
+  int k = left_chunks / _part_chunks;
+  if (k == 1) {
+    for (int i = 0; i < 8; ++i) left[i] = blake3_load32(_cvs + 4 * i);
+  } else {
+    blake3_merge_output(_cvs, _stride, k, _part_chunks, left_chunks, &child);
+    blake3_output_cv(&child, left);
+  }
+  if (_count - k == 1) {
+    for (int i = 0; i < 8; ++i) right[i] = blake3_load32(_cvs + k * _stride + 4 * i);
+  } else {
+    blake3_merge_output(_cvs + k * _stride, _stride, _count - k, _part_chunks, _chunks - left_chunks, &child);
+    blake3_output_cv(&child, right);
+  }
+  blake3_output_parent(left, right, _output);
+}
+
+/*
+ * void blake3_merge_subtrees( const unsigned char *cvs, size_t stride, int count, uint64_t part_len,
+ *                             uint64_t total, unsigned char *out );
+ *
+ * The function blake3_merge_subtrees() returns the BLAKE3 hash of total bytes
+ * hashed as count (> 1) parts: cvs - the part chaining values (stride bytes
+ * apart), part_len - the length of all parts but the last (power of 2 chunks).
+ */
+void blake3_merge_subtrees(const unsigned char *_cvs, size_t _stride, int _count, uint64_t _part_len,
+                           uint64_t _total, unsigned char *_out) {
+  struct BLAKE3_OUTPUT output;
+  uint64_t chunks = (_total + BLAKE3_CHUNK_LEN - 1) / BLAKE3_CHUNK_LEN;
+  blake3_merge_output(_cvs, _stride, _count, _part_len / BLAKE3_CHUNK_LEN, chunks, &output);
+  blake3_output_root(&output, _out);
+}
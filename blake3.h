@@ -0,0 +1,47 @@
+/*
+ *  File Check Daemon - BLAKE3-256 (режим hash, без ключа)
+ *
+ *  Потоковый расчёт по спецификации BLAKE3: вход делится на куски по 1 КиБ,
+ *  цепные значения кусков сворачиваются в двоичное дерево (стек cv_stack).
+ *
+ *  Дерево позволяет считать части файла разными потоками: часть длиной
+ *  2^k кусков, начинающаяся с кратного ей смещения, - целое поддерево.
+ *  blake3_hasher_init_at() начинает такую часть, blake3_hasher_subtree()
+ *  даёт цепное значение её поддерева, blake3_merge_subtrees() собирает
+ *  корень из цепных значений частей - результат тот же, что у расчёта целиком.
+ */
+#ifndef FICHEDA_BLAKE3_H
+#define FICHEDA_BLAKE3_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BLAKE3_OUT_LEN        32
+#define BLAKE3_BLOCK_LEN      64
+#define BLAKE3_CHUNK_LEN      1024
+#define BLAKE3_MAX_DEPTH      54
+
+struct BLAKE3_CHUNK {
+    uint32_t cv[8];
+    uint64_t counter;
+    unsigned char block[BLAKE3_BLOCK_LEN];
+    uint8_t block_len;
+    uint8_t blocks_compressed;
+};
+
+struct BLAKE3_HASHER {
+    struct BLAKE3_CHUNK chunk;
+    uint64_t chunks;
+    uint8_t cv_stack_len;
+    unsigned char cv_stack[BLAKE3_MAX_DEPTH * BLAKE3_OUT_LEN];
+};
+
+void blake3_hasher_init(struct BLAKE3_HASHER *_hasher);
+void blake3_hasher_init_at(struct BLAKE3_HASHER *_hasher, uint64_t _chunk);
+void blake3_hasher_update(struct BLAKE3_HASHER *_hasher, const void *_buf, size_t _len);
+void blake3_hasher_finalize(const struct BLAKE3_HASHER *_hasher, unsigned char *_out);
+void blake3_hasher_subtree(const struct BLAKE3_HASHER *_hasher, unsigned char *_cv);
+void blake3_merge_subtrees(const unsigned char *_cvs, size_t _stride, int _count, uint64_t _part_len,
+                           uint64_t _total, unsigned char *_out);
+
+#endif //FICHEDA_BLAKE3_H
@@ -0,0 +1,45 @@
+/*
+ *  File Check Daemon - ограничение нагрузки (token bucket)
+ *
+ *  Вместо счётчика жетонов хранится момент next_ns, когда уже списанные
+ *  единицы "окупятся" при заданной скорости. Поток, превысивший бюджет,
+ *  спит до этого момента (без удержания мьютекса).
+ */
+#include <errno.h>
+#include "budget.h"
+#include "ficheda.h"
+
+int64_t fcd_clock_ns(clockid_t _clock) {
+  struct timespec ts;
+  clock_gettime(_clock, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void fcd_sleep_ns(int64_t _ns) {
+  struct timespec ts;
+  ts.tv_sec = _ns / 1000000000;
+  ts.tv_nsec = _ns % 1000000000;
+  while (nanosleep(&ts, &ts) && errno == EINTR);
+}
+
+void fcd_budget_init(struct FCD_BUDGET *_budget, double _rate) {
+  if (pthread_mutex_init(&_budget->mutex, NULL)) severe_error_0("pthread_mutex_init(budget)", errno);
+  _budget->rate = _rate;
+  _budget->burst_ns = FCD_BUDGET_BURST_NS;
+  _budget->next_ns = 0;
+}
+
+int64_t fcd_budget_take(struct FCD_BUDGET *_budget, double _units) {
+  if (_budget->rate <= 0 || _units <= 0) return 0;
+  //  lock mutex
+  if (pthread_mutex_lock(&_budget->mutex)) severe_error_0("pthread_mutex_lock(budget)", errno);
+  int64_t now = fcd_clock_ns(CLOCK_MONOTONIC);
+  if (_budget->next_ns < now - _budget->burst_ns) _budget->next_ns = now - _budget->burst_ns;
+  _budget->next_ns += (int64_t)(_units * 1e9 / _budget->rate);
+  int64_t wait = _budget->next_ns - now;
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_budget->mutex)) severe_error_0("pthread_mutex_unlock(budget)", errno);
+  if (wait <= 0) return 0;
+  fcd_sleep_ns(wait);
+  return wait;
+}
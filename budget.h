@@ -0,0 +1,30 @@
+/*
+ *  File Check Daemon - ограничение нагрузки (token bucket)
+ *
+ *  - rate единиц в секунду (байты чтения, наносекунды CPU), 0 - без ограничения
+ *  - burst_ns - сколько времени простоя можно "накопить" для всплеска
+ *  - fcd_budget_take() списывает единицы и при превышении усыпляет поток,
+ *    возвращает время сна в нс
+ */
+#ifndef FICHEDA_BUDGET_H
+#define FICHEDA_BUDGET_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+#define FCD_BUDGET_BURST_NS   100000000ll
+
+struct FCD_BUDGET {
+    pthread_mutex_t mutex;
+    double rate;
+    int64_t burst_ns;
+    int64_t next_ns;
+};
+
+int64_t fcd_clock_ns(clockid_t _clock);
+void fcd_sleep_ns(int64_t _ns);
+void fcd_budget_init(struct FCD_BUDGET *_budget, double _rate);
+int64_t fcd_budget_take(struct FCD_BUDGET *_budget, double _units);
+
+#endif //FICHEDA_BUDGET_H
@@ -0,0 +1,344 @@
+/*
+ *  File Check Daemon - управление через Unix-сокет
+ *
+ *  Поток Control и потоки клиентов. Запросы verify и scan идут через список
+ *  touched миссии (fcd_touched_request()), сканирует их Calculators-Launcher,
+ *  клиент ждёт отчёта этого сканирования. Подписчики watch - в списке под
+ *  мьютексом, строки им пишет JSON-writer (fcd_control_publish()).
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <glob.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "control.h"
+#include "ficheda.h"
+#include "json.h"
+
+struct FCD_CONTROL_CLIENT {
+    struct FCD_CONTROL_CLIENT *next;
+    int fd;
+    struct FCD_JSON out;
+};
+
+char* mission_socket = NULL;
+
+int control_fd = -1;
+int control_clients = 0;
+struct FCD_CONTROL_CLIENT *control_watchers = NULL;
+pthread_mutex_t mutex_watchers = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * void fcd_control_init( void );
+ *
+ * The function fcd_control_init() creates the socket mission_socket (a stale
+ * one is removed), only the owner may connect.
+ */
+void fcd_control_init(void) {
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (strlen(mission_socket) >= sizeof(addr.sun_path)) severe_error_1("Control socket path is too long! Program stoped!");
+  strcpy(addr.sun_path, mission_socket);
+  control_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (control_fd < 0) severe_error_0("socket(mission_socket)", errno);
+  unlink(mission_socket);
+  if (bind(control_fd, (struct sockaddr *)&addr, sizeof(addr))) severe_error_0("bind(mission_socket)", errno);
+  //  the daemon works with umask(0)
+  if (chmod(mission_socket, S_IRUSR | S_IWUSR)) severe_error_0("chmod(mission_socket)", errno);
+  if (listen(control_fd, FCD_CONTROL_CLIENTS)) severe_error_0("listen(mission_socket)", errno);
+  syslog(LOG_NOTICE, "Control socket: %s", mission_socket);
+}
+
+//  1 - no empty, "." or ".." components: the name relative to the mission is its etalon name as is
+//  (glob() with GLOB_NOCHECK returns such a path unchanged, it could leave the mission directory)
+int fcd_control_canonical(const char *_path) {
+  const char *part = _path, *end;
+  while (*part == '/') {
+    end = strchrnul(++part, '/');
+    if (end == part || (part[0] == '.' && (end - part == 1 || (end - part == 2 && part[1] == '.')))) return 0;
+    part = end;
+  }
+  return 1;
+}
+
+//  the mission of an absolute path (the longest match), *_name - relative to its path
+struct FCD_MISSION *fcd_control_mission(const char *_path, const char **_name) {
+  struct FCD_MISSION *found = NULL;
+  size_t found_len = 0;
+  if (!fcd_control_canonical(_path)) return NULL;
+  for (struct FCD_MISSION *mission = fcd_missions; mission; mission = mission->next) {
+    size_t len = strlen(mission->path);
+    if (len <= found_len || strncmp(_path, mission->path, len) || _path[len] != '/' || !_path[len + 1]) continue;
+    //  not recursive - only the files of the mission directory itself
+    if (!mission->recursive && strchr(_path + len + 1, '/')) continue;
+    found = mission;
+    found_len = len;
+  }
+  if (found) *_name = _path + found_len + 1;
+  return found;
+}
+
+//  {"path":"...","error":"..."}
+void fcd_control_error(struct FCD_JSON *_out, const char *_path, const char *_text) {
+  fcd_json_literal(_out, "{\"path\":\"");
+  fcd_json_string(_out, _path);
+  fcd_json_literal(_out, "\",\"error\":\"");
+  fcd_json_string(_out, _text);
+  fcd_json_literal(_out, "\"}");
+}
+
+//  the record of a file from the etalon list of the mission (memory only)
+void fcd_control_record(struct FCD_JSON *_out, const char *_path) {
+  struct FCD_MISSION *mission;
+  struct FCD_FILE *fcd_file;
+  struct FCD_RESULT result;
+  const char *name;
+  int code = 0;
+  if (!fcd_control_canonical(_path)) {
+    fcd_control_error(_out, _path, "not a canonical path");
+    return;
+  }
+  if (!(mission = fcd_control_mission(_path, &name))) {
+    fcd_control_error(_out, _path, "not in a mission");
+    return;
+  }
+  //  lock mutex
+  if (pthread_mutex_lock(&mission->mutex_etalon)) severe_error_0("pthread_mutex_lock(mutex_etalon)", errno);
+  fcd_file = fcd_etalon_find(&mission->etalon, name);
+  if (fcd_file && (code = thread_calculators_launcher_code(fcd_file)))
+    thread_calculators_launcher_snapshot(mission, &result, fcd_file, code);
+  //  unlock mutex
+  if (pthread_mutex_unlock(&mission->mutex_etalon)) severe_error_0("pthread_mutex_unlock(mutex_etalon)", errno);
+  if (code) thread_json_writer_record(mission, _out, NULL, &result);
+  else fcd_control_error(_out, _path, "not in the etalon list");
+}
+
+//  {"files":[...]} - the files of the pattern re-hashed now (directories - their trees)
+void fcd_control_verify(struct FCD_JSON *_out, const char *_pattern) {
+  struct FCD_MISSION *mission;
+  const char *name;
+  char **names, *dirs;
+  size_t count, n;
+  glob_t found;
+  int first = 1;
+  if (_pattern[0] != '/') {
+    fcd_control_error(_out, _pattern, "not an absolute path");
+    return;
+  }
+  //  no match - the pattern itself: a deleted file is named as is
+  if (glob(_pattern, GLOB_NOCHECK | GLOB_MARK, NULL, &found)) {
+    fcd_control_error(_out, _pattern, "glob failed");
+    return;
+  }
+  //  GLOB_MARK - a directory ends with '/': scanned (its tree), not in the answer
+  dirs = my_malloc(found.gl_pathc);
+  for (n = 0; n < found.gl_pathc; ++n) {
+    size_t len = strlen(found.gl_pathv[n]);
+    dirs[n] = len > 1 && found.gl_pathv[n][len - 1] == '/';
+    if (dirs[n]) found.gl_pathv[n][len - 1] = '\0';
+  }
+  names = my_malloc(sizeof(char *) * found.gl_pathc);
+  for (mission = fcd_missions; mission; mission = mission->next) {
+    for (n = count = 0; n < found.gl_pathc; ++n)
+      if (fcd_control_mission(found.gl_pathv[n], &name) == mission) names[count++] = (char *)name;
+    if (count) fcd_touched_wait(mission, fcd_touched_request(mission, names, count, 0));
+  }
+  free(names);
+  fcd_json_literal(_out, "{\"files\":[");
+  for (n = 0; n < found.gl_pathc; ++n) {
+    if (dirs[n]) continue;
+    if (!first) fcd_json_literal(_out, ",");
+    first = 0;
+    fcd_control_record(_out, found.gl_pathv[n]);
+  }
+  fcd_json_literal(_out, "]}");
+  free(dirs);
+  globfree(&found);
+}
+
+//  {"missions":[...]} - a full scan of the mission (of all missions, _name empty)
+void fcd_control_scan(struct FCD_JSON *_out, const char *_name) {
+  struct FCD_MISSION *mission;
+  uint64_t *tickets;
+  int n, first = 1;
+  for (mission = fcd_missions, n = 0; mission; mission = mission->next) ++n;
+  tickets = my_malloc(sizeof(uint64_t) * n);
+  //  the missions scan at the same time, the answer waits for all of them
+  for (mission = fcd_missions, n = 0; mission; mission = mission->next, ++n)
+    if (!*_name || !strcmp(_name, mission->name)) tickets[n] = fcd_touched_request(mission, NULL, 0, 1);
+  for (mission = fcd_missions, n = 0; mission; mission = mission->next, ++n) {
+    if (*_name && strcmp(_name, mission->name)) continue;
+    fcd_touched_wait(mission, tickets[n]);
+    if (first) fcd_json_literal(_out, "{\"missions\":[{\"mission\":\"");
+    else fcd_json_literal(_out, ",{\"mission\":\"");
+    first = 0;
+    fcd_json_string(_out, mission->name);
+    fcd_json_literal(_out, "\",\"path\":\"");
+    fcd_json_string(_out, mission->path);
+    fcd_json_literal(_out, "\",\"files\":");
+    fcd_json_uint64(_out, __atomic_load_n(&mission->statuses[0], __ATOMIC_RELAXED));
+    fcd_json_literal(_out, ",\"ok\":");
+    fcd_json_uint64(_out, __atomic_load_n(&mission->statuses[FCD_RESULT_OK], __ATOMIC_RELAXED));
+    fcd_json_literal(_out, ",\"fail\":");
+    fcd_json_uint64(_out, __atomic_load_n(&mission->statuses[FCD_RESULT_FAIL], __ATOMIC_RELAXED));
+    fcd_json_literal(_out, ",\"error\":");
+    fcd_json_uint64(_out, __atomic_load_n(&mission->statuses[FCD_RESULT_ERR], __ATOMIC_RELAXED));
+    fcd_json_literal(_out, ",\"deleted\":");
+    fcd_json_uint64(_out, __atomic_load_n(&mission->statuses[FCD_RESULT_DEL], __ATOMIC_RELAXED));
+    fcd_json_literal(_out, ",\"new\":");
+    fcd_json_uint64(_out, __atomic_load_n(&mission->statuses[FCD_RESULT_NEW], __ATOMIC_RELAXED));
+    fcd_json_literal(_out, "}");
+  }
+  free(tickets);
+  if (first) {
+    fcd_json_literal(_out, "{\"mission\":\"");
+    fcd_json_string(_out, _name);
+    fcd_json_literal(_out, "\",\"error\":\"no such mission\"}");
+  }
+  else fcd_json_literal(_out, "]}");
+}
+
+/*
+ * void fcd_control_publish( struct FCD_MISSION *mission, struct FCD_REPORT *report );
+ *
+ * The function fcd_control_publish() sends the status changes of the report
+ * to every watcher, the JSON-writer of the mission calls it. A watcher that
+ * does not keep up is shut down, its thread removes it.
+ */
+void fcd_control_publish(struct FCD_MISSION *_mission, struct FCD_REPORT *_report) {
+  if (!__atomic_load_n(&control_watchers, __ATOMIC_RELAXED)) return;
+  //  lock mutex
+  if (pthread_mutex_lock(&mutex_watchers)) severe_error_0("pthread_mutex_lock(mutex_watchers)", errno);
+  for (struct FCD_CONTROL_CLIENT *client = control_watchers; client; client = client->next) {
+    if (client->out.errnum) continue;
+    for (size_t i = 0; i < _report->count; ++i)
+      if (_report->records[i].from != _report->records[i].code)
+        thread_json_writer_change(_mission, &client->out, _report, &_report->records[i]);
+    if (fcd_json_send(&client->out)) shutdown(client->fd, SHUT_RDWR);
+  }
+  //  unlock mutex
+  if (pthread_mutex_unlock(&mutex_watchers)) severe_error_0("pthread_mutex_unlock(mutex_watchers)", errno);
+}
+
+void fcd_control_watch(struct FCD_CONTROL_CLIENT *_client, int _on) {
+  struct FCD_CONTROL_CLIENT **last = &control_watchers;
+  //  lock mutex
+  if (pthread_mutex_lock(&mutex_watchers)) severe_error_0("pthread_mutex_lock(mutex_watchers)", errno);
+  if (_on) {
+    //  the events do not wait for the socket
+    _client->out.send_flags = MSG_DONTWAIT;
+    _client->next = control_watchers;
+    __atomic_store_n(&control_watchers, _client, __ATOMIC_RELAXED);
+  } else {
+    while (*last && *last != _client) last = &(*last)->next;
+    if (*last) *last = _client->next;
+  }
+  //  unlock mutex
+  if (pthread_mutex_unlock(&mutex_watchers)) severe_error_0("pthread_mutex_unlock(mutex_watchers)", errno);
+}
+
+//  one request line, returns 1 - the client watches now
+int fcd_control_request(struct FCD_CONTROL_CLIENT *_client, char *_line) {
+  char *arg = strchr(_line, ' ');
+  if (arg) *arg++ = '\0';
+  else arg = _line + strlen(_line);
+  if (!strcmp(_line, "status")) {
+    if (*arg == '/') fcd_control_record(&_client->out, arg);
+    else fcd_control_error(&_client->out, arg, "not an absolute path");
+  } else if (!strcmp(_line, "verify")) {
+    fcd_control_verify(&_client->out, arg);
+  } else if (!strcmp(_line, "scan")) {
+    fcd_control_scan(&_client->out, arg);
+  } else if (!strcmp(_line, "watch")) {
+    fcd_json_literal(&_client->out, "{\"watch\":true}\n");
+    fcd_json_send(&_client->out);
+    fcd_control_watch(_client, 1);
+    return 1;
+  } else {
+    fcd_json_literal(&_client->out, "{\"error\":\"unknown request\",\"request\":\"");
+    fcd_json_string(&_client->out, _line);
+    fcd_json_literal(&_client->out, "\"}");
+  }
+  fcd_json_literal(&_client->out, "\n");
+  fcd_json_send(&_client->out);
+  return 0;
+}
+
+//  one thread per client: request lines until the client closes the socket
+void *thread_control_client_entry_point(void *_arg) {
+  struct FCD_CONTROL_CLIENT *client = _arg;
+  char buff[FCD_CONTROL_LINE];
+  size_t len = 0;
+  ssize_t rc;
+  int watch = 0;
+  fcd_json_stream(&client->out, client->fd, 0);
+  while (!client->out.errnum && (rc = recv(client->fd, buff + len, sizeof(buff) - len, 0)) != 0) {
+    if (rc < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    //  a watcher only waits for the end of the connection
+    if (watch) continue;
+    len += rc;
+    char *line = buff, *end;
+    while (!watch && (end = memchr(line, '\n', buff + len - line))) {
+      *end = '\0';
+      if (end > line && end[-1] == '\r') end[-1] = '\0';
+      watch = fcd_control_request(client, line);
+      line = end + 1;
+    }
+    len -= line - buff;
+    memmove(buff, line, len);
+    if (len == sizeof(buff)) {
+      fcd_json_literal(&client->out, "{\"error\":\"request is too long\"}\n");
+      fcd_json_send(&client->out);
+      break;
+    }
+  }
+  if (watch) fcd_control_watch(client, 0);
+  close(client->fd);
+  fcd_json_free(&client->out);
+  free(client);
+  __atomic_sub_fetch(&control_clients, 1, __ATOMIC_RELAXED);
+  return NULL;
+}
+
+//  accepts the clients of the control socket
+_Noreturn void *thread_control_entry_point(void *_arg) {
+  pthread_attr_t attr;
+  pthread_t tid;
+  int fd, cc;
+  if (pthread_attr_init(&attr)) severe_error_0("pthread_attr_init(control)", errno);
+  if (pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED)) severe_error_0("pthread_attr_setdetachstate", errno);
+  while (1) {
+    fd = accept4(control_fd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno != EINTR && errno != ECONNABORTED) syslog(LOG_WARNING, "accept(mission_socket): %s", strerror(errno));
+      continue;
+    }
+    if (__atomic_add_fetch(&control_clients, 1, __ATOMIC_RELAXED) > FCD_CONTROL_CLIENTS) {
+      send(fd, "{\"error\":\"too many clients\"}\n", 29, MSG_NOSIGNAL | MSG_DONTWAIT);
+      close(fd);
+      __atomic_sub_fetch(&control_clients, 1, __ATOMIC_RELAXED);
+      continue;
+    }
+    struct FCD_CONTROL_CLIENT *client = my_malloc(sizeof(struct FCD_CONTROL_CLIENT));
+    client->next = NULL;
+    client->fd = fd;
+    cc = pthread_create(&tid, &attr, &thread_control_client_entry_point, client);
+    if (cc != 0) {
+      syslog(LOG_WARNING, "pthread_create(control client): %s", strerror(cc));
+      close(fd);
+      free(client);
+      __atomic_sub_fetch(&control_clients, 1, __ATOMIC_RELAXED);
+    }
+  }
+}
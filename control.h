@@ -0,0 +1,32 @@
+/*
+ *  File Check Daemon - управление через Unix-сокет
+ *
+ *  - сокет socket (права 0600), поток Control принимает соединения, на каждого
+ *    клиента - свой поток (не больше FCD_CONTROL_CLIENTS)
+ *  - запрос - строка текста, ответ - одна строка JSON:
+ *    - status <path> - статус файла из памяти (эталонный список миссии), без чтения
+ *    - verify <path|glob> - файлы сейчас же в очередь миссии (без debounce и gap),
+ *      сумма считается заново, ответ - после отчёта этого сканирования
+ *    - scan [mission] - полное сканирование миссии (всех миссий), ответ после отчёта
+ *    - watch - подписка: строки смен статуса (как в журнале changes) после каждого отчёта
+ *  - путь абсолютный, миссия - по самому длинному совпадению с её path
+ *  - ошибки клиента (обрыв, EPIPE) демон не завершают; подписчик, который не
+ *    успевает читать (EAGAIN), отключается - JSON-writer его не ждёт
+ */
+#ifndef FICHEDA_CONTROL_H
+#define FICHEDA_CONTROL_H
+
+#include <limits.h>
+#include "mission.h"
+#include "results.h"
+
+#define FCD_CONTROL_CLIENTS   16
+#define FCD_CONTROL_LINE      (PATH_MAX + 64)
+
+extern char* mission_socket;
+
+void fcd_control_init(void);
+void fcd_control_publish(struct FCD_MISSION *_mission, struct FCD_REPORT *_report);
+_Noreturn void *thread_control_entry_point(void *_arg);
+
+#endif //FICHEDA_CONTROL_H
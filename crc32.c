@@ -0,0 +1,364 @@
+/*
+ *  File Check Daemon - CRC-32 kernels
+ *
+ *  Все ядра работают с "сырым" состоянием CRC (без начальной и конечной
+ *  инверсии), поэтому их можно свободно чередовать внутри одного расчёта:
+ *  crc32_finish(crc32_update_block(crc32_start(), buf, len))
+ */
+#include <string.h>
+#include "crc32.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+static uint32_t crc32_bytewise(uint32_t crc, const unsigned char *buf, size_t len);
+static uint32_t crc32_slice16(uint32_t crc, const unsigned char *buf, size_t len);
+static int crc32_always(void);
+
+static uint32_t crc_tab32_slice[16][256];
+static uint32_t crc_x2n_table[32];
+static const struct CRC32_KERNEL *crc32_kernel = NULL;
+static uint32_t crc_tab32c[256];
+static uint32_t crc_x2n_table_c[32];
+static const struct CRC32_KERNEL *crc32c_kernel = NULL;
+
+/*
+ * Table for the CRC 32 calculation
+ */
+const uint32_t crc_tab32[256] = {
+  0x00000000ul, 0x77073096ul, 0xEE0E612Cul, 0x990951BAul, 0x076DC419ul, 0x706AF48Ful, 0xE963A535ul, 0x9E6495A3ul,
+  0x0EDB8832ul, 0x79DCB8A4ul, 0xE0D5E91Eul, 0x97D2D988ul, 0x09B64C2Bul, 0x7EB17CBDul, 0xE7B82D07ul, 0x90BF1D91ul,
+  0x1DB71064ul, 0x6AB020F2ul, 0xF3B97148ul, 0x84BE41DEul, 0x1ADAD47Dul, 0x6DDDE4EBul, 0xF4D4B551ul, 0x83D385C7ul,
+  0x136C9856ul, 0x646BA8C0ul, 0xFD62F97Aul, 0x8A65C9ECul, 0x14015C4Ful, 0x63066CD9ul, 0xFA0F3D63ul, 0x8D080DF5ul,
+  0x3B6E20C8ul, 0x4C69105Eul, 0xD56041E4ul, 0xA2677172ul, 0x3C03E4D1ul, 0x4B04D447ul, 0xD20D85FDul, 0xA50AB56Bul,
+  0x35B5A8FAul, 0x42B2986Cul, 0xDBBBC9D6ul, 0xACBCF940ul, 0x32D86CE3ul, 0x45DF5C75ul, 0xDCD60DCFul, 0xABD13D59ul,
+  0x26D930ACul, 0x51DE003Aul, 0xC8D75180ul, 0xBFD06116ul, 0x21B4F4B5ul, 0x56B3C423ul, 0xCFBA9599ul, 0xB8BDA50Ful,
+  0x2802B89Eul, 0x5F058808ul, 0xC60CD9B2ul, 0xB10BE924ul, 0x2F6F7C87ul, 0x58684C11ul, 0xC1611DABul, 0xB6662D3Dul,
+  0x76DC4190ul, 0x01DB7106ul, 0x98D220BCul, 0xEFD5102Aul, 0x71B18589ul, 0x06B6B51Ful, 0x9FBFE4A5ul, 0xE8B8D433ul,
+  0x7807C9A2ul, 0x0F00F934ul, 0x9609A88Eul, 0xE10E9818ul, 0x7F6A0DBBul, 0x086D3D2Dul, 0x91646C97ul, 0xE6635C01ul,
+  0x6B6B51F4ul, 0x1C6C6162ul, 0x856530D8ul, 0xF262004Eul, 0x6C0695EDul, 0x1B01A57Bul, 0x8208F4C1ul, 0xF50FC457ul,
+  0x65B0D9C6ul, 0x12B7E950ul, 0x8BBEB8EAul, 0xFCB9887Cul, 0x62DD1DDFul, 0x15DA2D49ul, 0x8CD37CF3ul, 0xFBD44C65ul,
+  0x4DB26158ul, 0x3AB551CEul, 0xA3BC0074ul, 0xD4BB30E2ul, 0x4ADFA541ul, 0x3DD895D7ul, 0xA4D1C46Dul, 0xD3D6F4FBul,
+  0x4369E96Aul, 0x346ED9FCul, 0xAD678846ul, 0xDA60B8D0ul, 0x44042D73ul, 0x33031DE5ul, 0xAA0A4C5Ful, 0xDD0D7CC9ul,
+  0x5005713Cul, 0x270241AAul, 0xBE0B1010ul, 0xC90C2086ul, 0x5768B525ul, 0x206F85B3ul, 0xB966D409ul, 0xCE61E49Ful,
+  0x5EDEF90Eul, 0x29D9C998ul, 0xB0D09822ul, 0xC7D7A8B4ul, 0x59B33D17ul, 0x2EB40D81ul, 0xB7BD5C3Bul, 0xC0BA6CADul,
+  0xEDB88320ul, 0x9ABFB3B6ul, 0x03B6E20Cul, 0x74B1D29Aul, 0xEAD54739ul, 0x9DD277AFul, 0x04DB2615ul, 0x73DC1683ul,
+  0xE3630B12ul, 0x94643B84ul, 0x0D6D6A3Eul, 0x7A6A5AA8ul, 0xE40ECF0Bul, 0x9309FF9Dul, 0x0A00AE27ul, 0x7D079EB1ul,
+  0xF00F9344ul, 0x8708A3D2ul, 0x1E01F268ul, 0x6906C2FEul, 0xF762575Dul, 0x806567CBul, 0x196C3671ul, 0x6E6B06E7ul,
+  0xFED41B76ul, 0x89D32BE0ul, 0x10DA7A5Aul, 0x67DD4ACCul, 0xF9B9DF6Ful, 0x8EBEEFF9ul, 0x17B7BE43ul, 0x60B08ED5ul,
+  0xD6D6A3E8ul, 0xA1D1937Eul, 0x38D8C2C4ul, 0x4FDFF252ul, 0xD1BB67F1ul, 0xA6BC5767ul, 0x3FB506DDul, 0x48B2364Bul,
+  0xD80D2BDAul, 0xAF0A1B4Cul, 0x36034AF6ul, 0x41047A60ul, 0xDF60EFC3ul, 0xA867DF55ul, 0x316E8EEFul, 0x4669BE79ul,
+  0xCB61B38Cul, 0xBC66831Aul, 0x256FD2A0ul, 0x5268E236ul, 0xCC0C7795ul, 0xBB0B4703ul, 0x220216B9ul, 0x5505262Ful,
+  0xC5BA3BBEul, 0xB2BD0B28ul, 0x2BB45A92ul, 0x5CB36A04ul, 0xC2D7FFA7ul, 0xB5D0CF31ul, 0x2CD99E8Bul, 0x5BDEAE1Dul,
+  0x9B64C2B0ul, 0xEC63F226ul, 0x756AA39Cul, 0x026D930Aul, 0x9C0906A9ul, 0xEB0E363Ful, 0x72076785ul, 0x05005713ul,
+  0x95BF4A82ul, 0xE2B87A14ul, 0x7BB12BAEul, 0x0CB61B38ul, 0x92D28E9Bul, 0xE5D5BE0Dul, 0x7CDCEFB7ul, 0x0BDBDF21ul,
+  0x86D3D2D4ul, 0xF1D4E242ul, 0x68DDB3F8ul, 0x1FDA836Eul, 0x81BE16CDul, 0xF6B9265Bul, 0x6FB077E1ul, 0x18B74777ul,
+  0x88085AE6ul, 0xFF0F6A70ul, 0x66063BCAul, 0x11010B5Cul, 0x8F659EFFul, 0xF862AE69ul, 0x616BFFD3ul, 0x166CCF45ul,
+  0xA00AE278ul, 0xD70DD2EEul, 0x4E048354ul, 0x3903B3C2ul, 0xA7672661ul, 0xD06016F7ul, 0x4969474Dul, 0x3E6E77DBul,
+  0xAED16A4Aul, 0xD9D65ADCul, 0x40DF0B66ul, 0x37D83BF0ul, 0xA9BCAE53ul, 0xDEBB9EC5ul, 0x47B2CF7Ful, 0x30B5FFE9ul,
+  0xBDBDF21Cul, 0xCABAC28Aul, 0x53B39330ul, 0x24B4A3A6ul, 0xBAD03605ul, 0xCDD70693ul, 0x54DE5729ul, 0x23D967BFul,
+  0xB3667A2Eul, 0xC4614AB8ul, 0x5D681B02ul, 0x2A6F2B94ul, 0xB40BBE37ul, 0xC30C8EA1ul, 0x5A05DF1Bul, 0x2D02EF8Dul
+};
+
+/*
+ * Tables for the slicing-by-16 calculation (crc_tab32_slice[0] == crc_tab32)
+ */
+static void crc32_slice16_tables(void) {
+  for (int n = 0; n < 256; ++n) crc_tab32_slice[0][n] = crc_tab32[n];
+  for (int k = 1; k < 16; ++k)
+    for (int n = 0; n < 256; ++n)
+      crc_tab32_slice[k][n] = (crc_tab32_slice[k-1][n] >> 8) ^ crc_tab32[crc_tab32_slice[k-1][n] & 0xFF];
+}
+
+static int crc32_always(void) {
+  return 1;
+}
+
+/*
+ *  bytewise - эталонное ядро, один байт за шаг
+ */
+static uint32_t crc32_bytewise(uint32_t crc, const unsigned char *buf, size_t len) {
+  while (len--) crc = crc32_update(crc, *(buf++));
+  return crc;
+}
+
+/*
+ *  slice16 - 16 байт за шаг через 16 таблиц (не зависит от порядка байт)
+ */
+static uint32_t crc32_slice16(uint32_t crc, const unsigned char *buf, size_t len) {
+  const uint32_t (*t)[256] = (const uint32_t (*)[256])crc_tab32_slice;
+  for (; len >= 16; len -= 16, buf += 16) {
+    crc = t[15][(buf[0] ^ crc) & 0xFF] ^ t[14][(buf[1] ^ (crc >> 8)) & 0xFF] ^
+          t[13][(buf[2] ^ (crc >> 16)) & 0xFF] ^ t[12][(buf[3] ^ (crc >> 24)) & 0xFF] ^
+          t[11][buf[4]] ^ t[10][buf[5]] ^ t[9][buf[6]] ^ t[8][buf[7]] ^
+          t[7][buf[8]] ^ t[6][buf[9]] ^ t[5][buf[10]] ^ t[4][buf[11]] ^
+          t[3][buf[12]] ^ t[2][buf[13]] ^ t[1][buf[14]] ^ t[0][buf[15]];
+  }
+  return crc32_bytewise(crc, buf, len);
+}
+
+#if defined(__x86_64__)
+/*
+ *  pclmul - свёртка по 64 байта за шаг (4 x 128 бит), затем 128 -> 64 -> 32 бита
+ *  и редукция Барретта. Константы - остатки x^n mod P(x) для отражённого полинома.
+ */
+static int crc32_pclmul_supported(void) {
+  unsigned int a, b, c, d;
+  if (!__get_cpuid(1, &a, &b, &c, &d)) return 0;
+  return (c & bit_PCLMUL) && (c & bit_SSE4_1);
+}
+
+__attribute__((target("pclmul,sse4.1")))
+static inline __m128i crc32_pclmul_fold(__m128i _x, __m128i _k, __m128i _next) {
+  __m128i lo = _mm_clmulepi64_si128(_x, _k, 0x00);
+  __m128i hi = _mm_clmulepi64_si128(_x, _k, 0x11);
+  return _mm_xor_si128(_mm_xor_si128(lo, hi), _next);
+}
+
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t crc32_pclmul(uint32_t crc, const unsigned char *buf, size_t len) {
+  if (len < 64) return crc32_slice16(crc, buf, len);
+  const __m128i mask32 = _mm_set_epi32(0, 0, 0, -1);
+  __m128i k = _mm_set_epi64x(0x1c6e41596, 0x154442bd4);
+  __m128i x1 = _mm_loadu_si128((const __m128i *)(buf + 0));
+  __m128i x2 = _mm_loadu_si128((const __m128i *)(buf + 16));
+  __m128i x3 = _mm_loadu_si128((const __m128i *)(buf + 32));
+  __m128i x4 = _mm_loadu_si128((const __m128i *)(buf + 48));
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+  buf += 64;
+  len -= 64;
+  //  fold 4 x 128 bit by 512 bit
+  for (; len >= 64; len -= 64, buf += 64) {
+    x1 = crc32_pclmul_fold(x1, k, _mm_loadu_si128((const __m128i *)(buf + 0)));
+    x2 = crc32_pclmul_fold(x2, k, _mm_loadu_si128((const __m128i *)(buf + 16)));
+    x3 = crc32_pclmul_fold(x3, k, _mm_loadu_si128((const __m128i *)(buf + 32)));
+    x4 = crc32_pclmul_fold(x4, k, _mm_loadu_si128((const __m128i *)(buf + 48)));
+  }
+  //  fold 4 x 128 bit into 128 bit
+  k = _mm_set_epi64x(0x0ccaa009e, 0x1751997d0);
+  x1 = crc32_pclmul_fold(x1, k, x2);
+  x1 = crc32_pclmul_fold(x1, k, x3);
+  x1 = crc32_pclmul_fold(x1, k, x4);
+  //  fold the rest of the buffer by 128 bit
+  for (; len >= 16; len -= 16, buf += 16)
+    x1 = crc32_pclmul_fold(x1, k, _mm_loadu_si128((const __m128i *)buf));
+  //  fold 128 bit into 64 bit (appends 32 zero bits)
+  x2 = _mm_clmulepi64_si128(k, x1, 0x01);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+  //  fold 64 bit into 32 bit
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_and_si128(x1, mask32);
+  x1 = _mm_clmulepi64_si128(x1, _mm_set_epi64x(0, 0x163cd6124), 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+  //  Barrett reduction 64 -> 32 bit
+  k = _mm_set_epi64x(0x1f7011641, 0x1db710641);
+  x2 = x1;
+  x1 = _mm_and_si128(x1, mask32);
+  x1 = _mm_clmulepi64_si128(x1, k, 0x10);
+  x1 = _mm_and_si128(x1, mask32);
+  x1 = _mm_clmulepi64_si128(x1, k, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+  crc = (uint32_t)_mm_extract_epi32(x1, 1);
+  //  tail
+  return crc32_slice16(crc, buf, len);
+}
+#endif
+
+#if defined(__aarch64__)
+/*
+ *  armv8 - аппаратные инструкции CRC32 (тот же полином, что и crc_tab32)
+ */
+static int crc32_armv8_supported(void) {
+  return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+}
+
+__attribute__((target("+crc")))
+static uint32_t crc32_armv8(uint32_t crc, const unsigned char *buf, size_t len) {
+  for (; len && ((uintptr_t)buf & 7); --len) crc = __crc32b(crc, *(buf++));
+  for (; len >= 8; len -= 8, buf += 8) {
+    uint64_t v;
+    memcpy(&v, buf, sizeof(v));
+    crc = __crc32d(crc, v);
+  }
+  for (; len; --len) crc = __crc32b(crc, *(buf++));
+  return crc;
+}
+#endif
+
+/*
+ *  CRC-32C (Castagnoli, отражённый полином 0x82F63B78): таблица строится при старте
+ */
+static void crc32c_tables(void) {
+  for (uint32_t n = 0; n < 256; ++n) {
+    uint32_t c = n;
+    for (int k = 0; k < 8; ++k) c = c & 1 ? (c >> 1) ^ CRC_POLY_32C : c >> 1;
+    crc_tab32c[n] = c;
+  }
+}
+
+static uint32_t crc32c_bytewise(uint32_t crc, const unsigned char *buf, size_t len) {
+  while (len--) crc = (crc >> 8) ^ crc_tab32c[(crc ^ *(buf++)) & 0xFF];
+  return crc;
+}
+
+#if defined(__x86_64__)
+/*
+ *  sse42 - инструкция CRC32 (SSE4.2) считает именно CRC-32C, 8 байт за шаг
+ */
+static int crc32c_sse42_supported(void) {
+  unsigned int a, b, c, d;
+  if (!__get_cpuid(1, &a, &b, &c, &d)) return 0;
+  return (c & bit_SSE4_2) != 0;
+}
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const unsigned char *buf, size_t len) {
+  uint64_t crc64;
+  for (; len && ((uintptr_t)buf & 7); --len) crc = _mm_crc32_u8(crc, *(buf++));
+  crc64 = crc;
+  for (; len >= 8; len -= 8, buf += 8) {
+    uint64_t v;
+    memcpy(&v, buf, sizeof(v));
+    crc64 = _mm_crc32_u64(crc64, v);
+  }
+  crc = (uint32_t)crc64;
+  for (; len; --len) crc = _mm_crc32_u8(crc, *(buf++));
+  return crc;
+}
+#endif
+
+#if defined(__aarch64__)
+__attribute__((target("+crc")))
+static uint32_t crc32c_armv8(uint32_t crc, const unsigned char *buf, size_t len) {
+  for (; len && ((uintptr_t)buf & 7); --len) crc = __crc32cb(crc, *(buf++));
+  for (; len >= 8; len -= 8, buf += 8) {
+    uint64_t v;
+    memcpy(&v, buf, sizeof(v));
+    crc = __crc32cd(crc, v);
+  }
+  for (; len; --len) crc = __crc32cb(crc, *(buf++));
+  return crc;
+}
+#endif
+
+/*
+ *  Список ядер в порядке предпочтения
+ */
+const struct CRC32_KERNEL crc32_kernels[] = {
+#if defined(__x86_64__)
+  {"pclmul", crc32_pclmul, crc32_pclmul_supported},
+#endif
+#if defined(__aarch64__)
+  {"armv8", crc32_armv8, crc32_armv8_supported},
+#endif
+  {"slice16", crc32_slice16, crc32_always},
+  {"bytewise", crc32_bytewise, crc32_always},
+  {NULL, NULL, NULL}
+};
+
+const struct CRC32_KERNEL crc32c_kernels[] = {
+#if defined(__x86_64__)
+  {"sse42", crc32c_sse42, crc32c_sse42_supported},
+#endif
+#if defined(__aarch64__)
+  {"armv8", crc32c_armv8, crc32_armv8_supported},
+#endif
+  {"bytewise", crc32c_bytewise, crc32_always},
+  {NULL, NULL, NULL}
+};
+
+/*
+ *  Сдвиг CRC на n нулевых байт - умножение на x^(8n) mod P(x) в GF(2)
+ *  (отражённое представление, x^0 - старший бит), как в zlib crc32_combine
+ */
+static uint32_t crc32_multmodp(uint32_t a, uint32_t b, uint32_t poly) {
+  uint32_t m = 1ul << 31, p = 0;
+  for (;;) {
+    if (a & m) {
+      p ^= b;
+      if ((a & (m - 1)) == 0) break;
+    }
+    m >>= 1;
+    b = b & 1 ? (b >> 1) ^ poly : b >> 1;
+  }
+  return p;
+}
+
+static void crc32_x2n_tables(uint32_t *table, uint32_t poly) {
+  uint32_t p = 1ul << 30;  //  x^1
+  table[0] = p;
+  for (int n = 1; n < 32; ++n) table[n] = p = crc32_multmodp(p, p, poly);
+}
+
+static uint32_t crc32_combine_poly(uint32_t crc1, uint32_t crc2, uint64_t len2, const uint32_t *table, uint32_t poly) {
+  uint32_t p = 1ul << 31;  //  x^0
+  for (int k = 3; len2; len2 >>= 1, ++k)
+    if (len2 & 1) p = crc32_multmodp(table[k & 31], p, poly);
+  return crc32_multmodp(p, crc1, poly) ^ crc2;
+}
+
+/*
+ * uint32_t crc32_combine( uint32_t crc1, uint32_t crc2, uint64_t len2 );
+ *
+ * The function crc32_combine() returns the CRC-32 of two concatenated blocks:
+ * crc1 - the state after the first block, crc2 - the raw state of the second
+ * block started from 0, len2 - the length of the second block in bytes.
+ */
+uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t len2) {
+  return crc32_combine_poly(crc1, crc2, len2, crc_x2n_table, CRC_POLY_32);
+}  /* crc32_combine */
+
+uint32_t crc32c_combine(uint32_t crc1, uint32_t crc2, uint64_t len2) {
+  return crc32_combine_poly(crc1, crc2, len2, crc_x2n_table_c, CRC_POLY_32C);
+}  /* crc32c_combine */
+
+/*
+ * void crc32_init( void );
+ *
+ * The function crc32_init() builds the slicing tables and selects the fastest
+ * kernel supported by the CPU. Must be called before any worker thread starts.
+ */
+void crc32_init(void) {
+  crc32_slice16_tables();
+  crc32_x2n_tables(crc_x2n_table, CRC_POLY_32);
+  crc32c_tables();
+  crc32_x2n_tables(crc_x2n_table_c, CRC_POLY_32C);
+  for (const struct CRC32_KERNEL *kernel = crc32_kernels; kernel->name; ++kernel) {
+    if (kernel->supported()) {
+      crc32_kernel = kernel;
+      break;
+    }
+  }
+  for (const struct CRC32_KERNEL *kernel = crc32c_kernels; kernel->name; ++kernel) {
+    if (kernel->supported()) {
+      crc32c_kernel = kernel;
+      break;
+    }
+  }
+}  /* crc32_init */
+
+const char *crc32_kernel_name(void) {
+  return crc32_kernel ? crc32_kernel->name : "bytewise";
+}
+
+const char *crc32c_kernel_name(void) {
+  return crc32c_kernel ? crc32c_kernel->name : "bytewise";
+}
+
+uint32_t crc32_update_block(uint32_t crc, const void *buf, size_t len) {
+  if (!crc32_kernel) return crc32_bytewise(crc, buf, len);
+  return crc32_kernel->update(crc, buf, len);
+}  /* crc32_update_block */
+
+uint32_t crc32c_update_block(uint32_t crc, const void *buf, size_t len) {
+  if (!crc32c_kernel) return crc32c_bytewise(crc, buf, len);
+  return crc32c_kernel->update(crc, buf, len);
+}  /* crc32c_update_block */
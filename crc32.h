@@ -0,0 +1,89 @@
+/*
+ *  File Check Daemon - CRC-32 (IEEE 802.3, reflected, poly 0xEDB88320)
+ *
+ *  Блочный API расчёта CRC-32:
+ *  - crc32_init() выбирает ядро расчёта по CPUID (один раз при старте)
+ *  - crc32_update_block() считает CRC по буферу выбранным ядром
+ *  - результат всех ядер побитно совпадает с табличным crc32_update()
+ *  - crc32_combine() склеивает CRC соседних диапазонов (расчёт частей файла
+ *    разными потоками даёт тот же результат, что и последовательный)
+ *  - crc32c_*() - то же для CRC-32C (Castagnoli, poly 0x82F63B78), начальное
+ *    значение и конечная инверсия те же, что у CRC-32
+ *
+ *  Ядра:
+ *  - bytewise  - по одному байту через crc_tab32 (эталон)
+ *  - slice16   - slicing-by-16, переносимое
+ *  - pclmul    - свёртка через carry-less multiply (x86-64, PCLMULQDQ + SSE4.1)
+ *  - armv8     - инструкции CRC32X/CRC32B (AArch64, HWCAP_CRC32)
+ *
+ *  Ядра CRC-32C:
+ *  - sse42     - инструкция CRC32 (x86-64, SSE4.2)
+ *  - armv8     - инструкции CRC32CX/CRC32CB (AArch64, HWCAP_CRC32)
+ *  - bytewise  - по одному байту через таблицу
+ */
+#ifndef FICHEDA_CRC32_H
+#define FICHEDA_CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CRC_START_32      0xFFFFFFFFul
+#define CRC_POLY_32       0xEDB88320ul
+#define CRC_POLY_32C      0x82F63B78ul
+
+typedef uint32_t (*crc32_kernel_fn)(uint32_t crc, const unsigned char *buf, size_t len);
+
+struct CRC32_KERNEL {
+    const char *name;
+    crc32_kernel_fn update;
+    int (*supported)(void);
+};
+
+extern const uint32_t crc_tab32[256];
+extern const struct CRC32_KERNEL crc32_kernels[];
+extern const struct CRC32_KERNEL crc32c_kernels[];
+
+void crc32_init(void);
+const char *crc32_kernel_name(void);
+const char *crc32c_kernel_name(void);
+
+/*
+ * uint32_t crc32_update_block( uint32_t crc, const void *buf, size_t len );
+ *
+ * The function crc32_update_block() calculates a new CRC-32 value based on the
+ * previous value of the CRC and the next len bytes of the data to be checked.
+ */
+uint32_t crc32_update_block(uint32_t crc, const void *buf, size_t len);
+uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t len2);
+uint32_t crc32c_update_block(uint32_t crc, const void *buf, size_t len);
+uint32_t crc32c_combine(uint32_t crc1, uint32_t crc2, uint64_t len2);
+
+/*
+ * uint32_t crc_32_start( uint32_t crc, unsigned char c );
+ *
+ * The function crc32_start() return initialize CRC-32 value
+ */
+static inline uint32_t crc32_start() {
+  return CRC_START_32;
+}  /* crc32_start */
+
+/*
+ * uint32_t crc_32_update( uint32_t crc, unsigned char c );
+ *
+ * The function crc32_update() calculates a new CRC-32 value based on the
+ * previous value of the CRC and the next byte of the data to be checked.
+ */
+static inline uint32_t crc32_update(uint32_t crc, unsigned char c) {
+  return (crc >> 8) ^ crc_tab32[(crc ^ (uint32_t) c) & 0x000000FFul];
+}  /* crc32_update */
+
+/*
+ * uint32_t crc_32_finish( uint32_t crc, unsigned char c );
+ *
+ * The function crc32_finish() return finalize CRC-32 value
+ */
+static inline uint32_t crc32_finish(uint32_t crc) {
+  return (crc ^= 0xffffffffL);
+}  /* crc32_finish */
+
+#endif //FICHEDA_CRC32_H
@@ -0,0 +1,87 @@
+/*
+ *  File Check Daemon - блочное устройство каталога миссии
+ *
+ *  /sys/dev/block/MAJ:MIN - ссылка на каталог устройства в sysfs. У раздела
+ *  (файл partition) своей очереди нет - rotational и nr_requests берутся у
+ *  диска, это каталог выше. Устройство device-mapper (LVM, dm-crypt) или md
+ *  очередь имеет, её значения - как у нижних дисков.
+ */
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#include "device.h"
+
+const char *fcd_device_kind_names[] = {"virtual", "ssd", "hdd", NULL};
+
+//  a number from a sysfs file, -1 - no file
+static long fcd_device_number(const char *_dir, const char *_file) {
+  char path[PATH_MAX], text[32];
+  snprintf(path, sizeof(path), "%s/%s", _dir, _file);
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return -1;
+  ssize_t len = read(fd, text, sizeof(text) - 1);
+  close(fd);
+  if (len <= 0) return -1;
+  text[len] = '\0';
+  return strtol(text, NULL, 10);
+}
+
+/*
+ * void fcd_device_probe( struct FCD_DEVICE *device, const char *path );
+ *
+ * The function fcd_device_probe() finds the block device that backs path
+ * (the disk of a partition) and reads its rotational flag and queue depth.
+ * No block device or no sysfs - the kind FCD_DEVICE_VIRTUAL.
+ */
+void fcd_device_probe(struct FCD_DEVICE *_device, const char *_path) {
+  struct stat st;
+  char link[64], dir[PATH_MAX];
+  memset(_device, 0, sizeof(struct FCD_DEVICE));
+  _device->kind = FCD_DEVICE_VIRTUAL;
+  //  major 0 - anonymous device (tmpfs, NFS, overlay, btrfs)
+  if (stat(_path, &st) || major(st.st_dev) == 0) return;
+  snprintf(link, sizeof(link), "/sys/dev/block/%u:%u", major(st.st_dev), minor(st.st_dev));
+  if (!realpath(link, dir)) return;
+  if (fcd_device_number(dir, "partition") > 0) *strrchr(dir, '/') = '\0';
+  snprintf(_device->name, sizeof(_device->name), "%s", strrchr(dir, '/') + 1);
+  long rotational = fcd_device_number(dir, "queue/rotational");
+  if (rotational < 0) return;
+  _device->kind = rotational ? FCD_DEVICE_HDD : FCD_DEVICE_SSD;
+  long depth = fcd_device_number(dir, "queue/nr_requests");
+  _device->queue_depth = depth > 0 && depth < INT_MAX ? depth : 0;
+}
+
+/*
+ * void fcd_device_concurrency( const struct FCD_DEVICE *device, int *level, int *ceiling );
+ *
+ * The function fcd_device_concurrency() returns the number of jobs of a
+ * mission at once to start with, and the most that the runtime tuning may try.
+ */
+void fcd_device_concurrency(const struct FCD_DEVICE *_device, int *_level, int *_ceiling) {
+  int cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (cpus < 1) cpus = 1;
+  switch (_device->kind) {
+    case FCD_DEVICE_HDD:
+      *_level = FCD_DEVICE_HDD_LEVEL;
+      *_ceiling = FCD_DEVICE_HDD_CEILING;
+      return;
+    case FCD_DEVICE_SSD:
+      //  the hash is the limit while the queue is not full
+      *_level = cpus < 2 ? 2 : cpus;
+      *_ceiling = cpus < 2 ? 4 : 2 * cpus;
+      if (_device->queue_depth) {
+        if (*_ceiling > _device->queue_depth) *_ceiling = _device->queue_depth;
+        if (*_level > *_ceiling) *_level = *_ceiling;
+      }
+      return;
+    default:
+      *_level = cpus;
+      *_ceiling = 2 * cpus;
+      return;
+  }
+}
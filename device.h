@@ -0,0 +1,35 @@
+/*
+ *  File Check Daemon - блочное устройство каталога миссии
+ *
+ *  - st_dev каталога -> /sys/dev/block/MAJ:MIN, для раздела - его диск (каталог выше)
+ *  - queue/rotational - HDD, иначе SSD/NVMe; queue/nr_requests - глубина очереди
+ *  - нет блочного устройства (tmpfs, NFS, overlay, btrfs) - virtual
+ *  - fcd_device_concurrency() - начальный и наибольший уровень параллельности чтения:
+ *    HDD - мало потоков (поиск дорожки дороже чтения), SSD/NVMe - от числа процессоров
+ *    до глубины очереди, virtual - от числа процессоров
+ */
+#ifndef FICHEDA_DEVICE_H
+#define FICHEDA_DEVICE_H
+
+#define FCD_DEVICE_NAME           32
+#define FCD_DEVICE_HDD_LEVEL      2
+#define FCD_DEVICE_HDD_CEILING    4
+
+enum FCD_DEVICE_KIND {
+  FCD_DEVICE_VIRTUAL,
+  FCD_DEVICE_SSD,
+  FCD_DEVICE_HDD
+};
+
+struct FCD_DEVICE {
+    char name[FCD_DEVICE_NAME];
+    enum FCD_DEVICE_KIND kind;
+    int queue_depth;
+};
+
+extern const char *fcd_device_kind_names[];
+
+void fcd_device_probe(struct FCD_DEVICE *_device, const char *_path);
+void fcd_device_concurrency(const struct FCD_DEVICE *_device, int *_level, int *_ceiling);
+
+#endif //FICHEDA_DEVICE_H
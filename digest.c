@@ -0,0 +1,151 @@
+/*
+ *  File Check Daemon - алгоритм контрольной суммы миссии
+ */
+#include <string.h>
+#include "crc32.h"
+#include "digest.h"
+
+static void fcd_digest_be(unsigned char *_out, uint64_t _value, int _size) {
+  for (int i = _size - 1; i >= 0; --i, _value >>= 8) _out[i] = _value;
+}
+
+//  the first part continues crc32_start(), the others start from 0 (see crc32_combine)
+static void fcd_digest_crc_init(union FCD_DIGEST_STATE *_state, uint64_t _offset) {
+  _state->crc32 = _offset ? 0 : crc32_start();
+}
+
+static void fcd_digest_crc_final(const union FCD_DIGEST_STATE *_state, unsigned char *_out) {
+  fcd_digest_be(_out, crc32_finish(_state->crc32), 4);
+}
+
+static void fcd_digest_crc_part(const union FCD_DIGEST_STATE *_state, unsigned char *_value) {
+  memcpy(_value, &_state->crc32, sizeof(_state->crc32));
+}
+
+static void fcd_digest_crc_merge(const struct FCD_DIGEST_PART *_parts, int _count,
+                                 uint32_t (*_combine)(uint32_t, uint32_t, uint64_t), unsigned char *_out) {
+  uint32_t crc, next;
+  memcpy(&crc, _parts[0].value, sizeof(crc));
+  for (int i = 1; i < _count; ++i) {
+    memcpy(&next, _parts[i].value, sizeof(next));
+    crc = _combine(crc, next, _parts[i].bytes);
+  }
+  fcd_digest_be(_out, crc32_finish(crc), 4);
+}
+
+static void fcd_digest_crc32_update(union FCD_DIGEST_STATE *_state, const void *_buf, size_t _len) {
+  _state->crc32 = crc32_update_block(_state->crc32, _buf, _len);
+}
+
+static void fcd_digest_crc32_merge(const struct FCD_DIGEST_PART *_parts, int _count, uint64_t _chunk,
+                                   unsigned char *_out) {
+  fcd_digest_crc_merge(_parts, _count, &crc32_combine, _out);
+}
+
+static void fcd_digest_crc32c_update(union FCD_DIGEST_STATE *_state, const void *_buf, size_t _len) {
+  _state->crc32 = crc32c_update_block(_state->crc32, _buf, _len);
+}
+
+static void fcd_digest_crc32c_merge(const struct FCD_DIGEST_PART *_parts, int _count, uint64_t _chunk,
+                                    unsigned char *_out) {
+  fcd_digest_crc_merge(_parts, _count, &crc32c_combine, _out);
+}
+
+static void fcd_digest_xxh3_init(union FCD_DIGEST_STATE *_state, uint64_t _offset) {
+  xxh3_init(&_state->xxh3);
+}
+
+static void fcd_digest_xxh3_update(union FCD_DIGEST_STATE *_state, const void *_buf, size_t _len) {
+  xxh3_update(&_state->xxh3, _buf, _len);
+}
+
+static void fcd_digest_xxh3_final(const union FCD_DIGEST_STATE *_state, unsigned char *_out) {
+  fcd_digest_be(_out, xxh3_final(&_state->xxh3), 8);
+}
+
+static const char *fcd_digest_xxh3_kernel(void) {
+  return "scalar";
+}
+
+//  a part starts with the chunk at its offset (the offset is a multiple of the part size)
+static void fcd_digest_blake3_init(union FCD_DIGEST_STATE *_state, uint64_t _offset) {
+  blake3_hasher_init_at(&_state->blake3, _offset / BLAKE3_CHUNK_LEN);
+}
+
+static void fcd_digest_blake3_update(union FCD_DIGEST_STATE *_state, const void *_buf, size_t _len) {
+  blake3_hasher_update(&_state->blake3, _buf, _len);
+}
+
+static void fcd_digest_blake3_final(const union FCD_DIGEST_STATE *_state, unsigned char *_out) {
+  blake3_hasher_finalize(&_state->blake3, _out);
+}
+
+static void fcd_digest_blake3_part(const union FCD_DIGEST_STATE *_state, unsigned char *_value) {
+  blake3_hasher_subtree(&_state->blake3, _value);
+}
+
+static void fcd_digest_blake3_merge(const struct FCD_DIGEST_PART *_parts, int _count, uint64_t _chunk,
+                                    unsigned char *_out) {
+  uint64_t total = 0;
+  for (int i = 0; i < _count; ++i) total += _parts[i].bytes;
+  blake3_merge_subtrees(_parts[0].value, sizeof(struct FCD_DIGEST_PART), _count, _chunk, total, _out);
+}
+
+static const char *fcd_digest_blake3_kernel(void) {
+  return "portable";
+}
+
+const struct FCD_DIGEST fcd_digests[] = {
+  {"crc32", "CRC32", 4, 1, FCD_DIGEST_SPLIT_ANY, fcd_digest_crc_init, fcd_digest_crc32_update, fcd_digest_crc_final,
+   fcd_digest_crc_part, fcd_digest_crc32_merge, crc32_kernel_name},
+  {"crc32c", "CRC32C", 4, 1, FCD_DIGEST_SPLIT_ANY, fcd_digest_crc_init, fcd_digest_crc32c_update, fcd_digest_crc_final,
+   fcd_digest_crc_part, fcd_digest_crc32c_merge, crc32c_kernel_name},
+  {"xxh3", "XXH3", 8, 1, FCD_DIGEST_SPLIT_NONE, fcd_digest_xxh3_init, fcd_digest_xxh3_update, fcd_digest_xxh3_final,
+   NULL, NULL, fcd_digest_xxh3_kernel},
+  {"blake3", "BLAKE3", BLAKE3_OUT_LEN, 0, FCD_DIGEST_SPLIT_POW2, fcd_digest_blake3_init, fcd_digest_blake3_update,
+   fcd_digest_blake3_final, fcd_digest_blake3_part, fcd_digest_blake3_merge, fcd_digest_blake3_kernel},
+  {NULL, NULL, 0, 0, 0, NULL, NULL, NULL, NULL, NULL, NULL}
+};
+
+const struct FCD_DIGEST *fcd_digest = &fcd_digests[0];
+
+/*
+ * int fcd_digest_select( const char *name );
+ *
+ * The function fcd_digest_select() makes the algorithm name the mission one.
+ * Returns 0 or -1 (unknown name).
+ */
+int fcd_digest_select(const char *_name) {
+  for (const struct FCD_DIGEST *digest = fcd_digests; digest->name; ++digest) {
+    if (strcmp(digest->name, _name) == 0) {
+      fcd_digest = digest;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+//  the number of the mission algorithm in fcd_digests[] (etalon database flags)
+int fcd_digest_id(void) {
+  return fcd_digest - fcd_digests;
+}
+
+/*
+ * void fcd_digest_hex( const unsigned char *value, char *out );
+ *
+ * The function fcd_digest_hex() writes the value of the mission algorithm as
+ * text into out (FCD_DIGEST_HEX bytes): "0x%08X" for CRC32, lowercase bytes
+ * for blake3.
+ */
+void fcd_digest_hex(const unsigned char *_value, char *_out) {
+  const char *digits = fcd_digest->integer ? "0123456789ABCDEF" : "0123456789abcdef";
+  if (fcd_digest->integer) {
+    *_out++ = '0';
+    *_out++ = 'x';
+  }
+  for (int i = 0; i < fcd_digest->size; ++i) {
+    *_out++ = digits[_value[i] >> 4];
+    *_out++ = digits[_value[i] & 15];
+  }
+  *_out = '\0';
+}
@@ -0,0 +1,67 @@
+/*
+ *  File Check Daemon - алгоритм контрольной суммы миссии
+ *
+ *  Один алгоритм на миссию (algorithm), выбирается при старте:
+ *  - crc32   - CRC-32 (IEEE), по умолчанию, ядро по CPUID (crc32.h)
+ *  - crc32c  - CRC-32C (Castagnoli), ядро по CPUID (SSE4.2 / ARMv8)
+ *  - xxh3    - XXH3-64, быстрее любого CRC, не криптографический
+ *  - blake3  - BLAKE3-256, криптографический (от подмены содержимого)
+ *
+ *  Значение хранится как массив байт до FCD_DIGEST_MAX: числовые суммы
+ *  (integer) - старшим байтом вперёд, в отчёте "0x..." заглавными, как
+ *  прежний CRC32; blake3 - байты хэша, в отчёте строчными.
+ *
+ *  Большой файл считается частями (split):
+ *  - CRC - части с любой границы, склейка crc*_combine()
+ *  - blake3 - части по 2^k КиБ, каждая - поддерево BLAKE3, склейка в корень
+ *  - xxh3 - только целиком (состояние не склеивается)
+ */
+#ifndef FICHEDA_DIGEST_H
+#define FICHEDA_DIGEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "blake3.h"
+#include "xxh3.h"
+
+#define FCD_DIGEST_MAX        32
+#define FCD_DIGEST_HEX        (2 + 2 * FCD_DIGEST_MAX + 1)
+
+#define FCD_DIGEST_SPLIT_NONE 0
+#define FCD_DIGEST_SPLIT_ANY  1
+#define FCD_DIGEST_SPLIT_POW2 2
+
+union FCD_DIGEST_STATE {
+    uint32_t crc32;
+    struct XXH3_STATE xxh3;
+    struct BLAKE3_HASHER blake3;
+};
+
+//  the value of one part of a split file
+struct FCD_DIGEST_PART {
+    unsigned char value[FCD_DIGEST_MAX];
+    uint64_t bytes;
+};
+
+struct FCD_DIGEST {
+    const char *name;
+    const char *label;
+    int size;
+    int integer;
+    int split;
+    void (*init)(union FCD_DIGEST_STATE *_state, uint64_t _offset);
+    void (*update)(union FCD_DIGEST_STATE *_state, const void *_buf, size_t _len);
+    void (*final)(const union FCD_DIGEST_STATE *_state, unsigned char *_out);
+    void (*part)(const union FCD_DIGEST_STATE *_state, unsigned char *_value);
+    void (*merge)(const struct FCD_DIGEST_PART *_parts, int _count, uint64_t _chunk, unsigned char *_out);
+    const char *(*kernel)(void);
+};
+
+extern const struct FCD_DIGEST fcd_digests[];
+extern const struct FCD_DIGEST *fcd_digest;
+
+int fcd_digest_select(const char *_name);
+int fcd_digest_id(void);
+void fcd_digest_hex(const unsigned char *_value, char *_out);
+
+#endif //FICHEDA_DIGEST_H
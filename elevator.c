@@ -0,0 +1,66 @@
+/*
+ *  File Check Daemon - порядок чтения по месту файлов на диске (elevator)
+ *
+ *  Ключ сортировки - номер inode или смещение первого экстента, при равных
+ *  ключах - номер inode. FIEMAP спрашивает один экстент без FIEMAP_FLAG_SYNC
+ *  (не сбрасывает грязные страницы): у ещё не размещённого файла смещение 0.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include "elevator.h"
+#include "ficheda.h"
+
+const char *fcd_order_names[] = {"auto", "readdir", "inode", "extent", NULL};
+
+//  the list lives across scans, only grows
+void fcd_elevator_push(struct FCD_ELEVATOR *_elevator, uint64_t _ino, struct FCD_FILE *_file) {
+  if (_elevator->count == _elevator->capacity) {
+    _elevator->capacity = _elevator->capacity ? _elevator->capacity * 2 : 1024;
+    struct FCD_ELEVATOR_ITEM *items = my_malloc(sizeof(struct FCD_ELEVATOR_ITEM) * _elevator->capacity);
+    if (_elevator->count) memcpy(items, _elevator->items, sizeof(struct FCD_ELEVATOR_ITEM) * _elevator->count);
+    free(_elevator->items);
+    _elevator->items = items;
+  }
+  struct FCD_ELEVATOR_ITEM *item = &_elevator->items[_elevator->count++];
+  item->key = item->ino = _ino;
+  item->file = _file;
+}
+
+static int fcd_elevator_cmp(const void *_a, const void *_b) {
+  const struct FCD_ELEVATOR_ITEM *a = _a, *b = _b;
+  if (a->key != b->key) return a->key < b->key ? -1 : 1;
+  return a->ino < b->ino ? -1 : a->ino > b->ino;
+}
+
+void fcd_elevator_sort(struct FCD_ELEVATOR *_elevator) {
+  qsort(_elevator->items, _elevator->count, sizeof(struct FCD_ELEVATOR_ITEM), &fcd_elevator_cmp);
+}
+
+/*
+ * int fcd_elevator_extent( int dirfd, const char *name, uint64_t *physical );
+ *
+ * The function fcd_elevator_extent() returns in physical the disk offset of
+ * the first extent of the file (0 - no extents). Returns 0 or errno; EOPNOTSUPP
+ * and ENOTTY - the file system has no FIEMAP.
+ */
+int fcd_elevator_extent(int _dirfd, const char *_name, uint64_t *_physical) {
+  uint64_t buff[(sizeof(struct fiemap) + sizeof(struct fiemap_extent)) / sizeof(uint64_t) + 1];
+  struct fiemap *map = (struct fiemap *)buff;
+  int cc = 0;
+  *_physical = 0;
+  int fd = openat(_dirfd, _name, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return errno;
+  memset(buff, 0, sizeof(buff));
+  map->fm_length = FIEMAP_MAX_OFFSET;
+  map->fm_extent_count = 1;
+  if (ioctl(fd, FS_IOC_FIEMAP, map)) cc = errno;
+  else if (map->fm_mapped_extents) *_physical = map->fm_extents[0].fe_physical;
+  close(fd);
+  return cc;
+}
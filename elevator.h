@@ -0,0 +1,47 @@
+/*
+ *  File Check Daemon - порядок чтения по месту файлов на диске (elevator)
+ *
+ *  - order миссии: readdir - как вернул getdents64(), inode - по номеру inode
+ *    (дёшево, на ext4/xfs близко к порядку на диске), extent - по физическому
+ *    смещению первого экстента (FIEMAP), auto - extent для HDD, иначе readdir
+ *  - полное сканирование собирает файлы обхода в список, сортирует и только
+ *    потом читает - головка диска идёт в одну сторону, а не между файлами
+ *  - список читают concurrency заданий пула, каждое берёт следующий файл (next),
+ *    а не задание на файл - нет передачи каждого файла между потоками
+ *  - файловая система без FIEMAP (tmpfs, NFS) - порядок inode
+ */
+#ifndef FICHEDA_ELEVATOR_H
+#define FICHEDA_ELEVATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "etalon.h"
+
+enum FCD_ORDER {
+  FCD_ORDER_AUTO,
+  FCD_ORDER_READDIR,
+  FCD_ORDER_INODE,
+  FCD_ORDER_EXTENT
+};
+
+struct FCD_ELEVATOR_ITEM {
+    uint64_t key;
+    uint64_t ino;
+    struct FCD_FILE *file;
+};
+
+struct FCD_ELEVATOR {
+    struct FCD_ELEVATOR_ITEM *items;
+    size_t count;
+    size_t capacity;
+    //  the next file to read - taken by concurrency jobs at once
+    size_t next;
+};
+
+extern const char *fcd_order_names[];
+
+void fcd_elevator_push(struct FCD_ELEVATOR *_elevator, uint64_t _ino, struct FCD_FILE *_file);
+void fcd_elevator_sort(struct FCD_ELEVATOR *_elevator);
+int fcd_elevator_extent(int _dirfd, const char *_name, uint64_t *_physical);
+
+#endif //FICHEDA_ELEVATOR_H
@@ -0,0 +1,275 @@
+/*
+ *  File Check Daemon - эталонный список на диске
+ *
+ *  Контрольная сумма - CRC-32 всего файла после заголовка: повреждение файла
+ *  обнаруживается при загрузке, такой файл не используется. От правки не защищает -
+ *  кто может писать файл, пересчитает и сумму; защита - права 0600 на файл и каталог.
+ *
+ *  Сохраняются файлы эталона (OLD, а также DELETED и с ошибкой); у файла не OK
+ *  подпись stat() пустая - при следующем запуске он читается и снова не OK.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "crc32.h"
+#include "etadb.h"
+#include "ficheda.h"
+
+#define FCD_ETADB_BUFF    1048576
+
+static int fcd_etadb_write(int _fd, const void *_buf, size_t _len, uint32_t *_crc) {
+  *_crc = crc32_update_block(*_crc, _buf, _len);
+  for (const char *ptr = _buf; _len;) {
+    ssize_t wl = write(_fd, ptr, _len);
+    if (wl < 0) {
+      if (errno == EINTR) continue;
+      return errno;
+    }
+    ptr += wl;
+    _len -= wl;
+  }
+  return 0;
+}
+
+//  append to the write buffer, flush it when full
+static int fcd_etadb_put(int _fd, unsigned char *_buff, size_t *_used, const void *_src, size_t _len, uint32_t *_crc) {
+  int cc;
+  if (*_used + _len > FCD_ETADB_BUFF) {
+    if ((cc = fcd_etadb_write(_fd, _buff, *_used, _crc))) return cc;
+    *_used = 0;
+  }
+  memcpy(_buff + *_used, _src, _len);
+  *_used += _len;
+  return 0;
+}
+
+//  a file of the etalon list (not new)
+static int fcd_etadb_kept(struct FCD_FILE *_fcd_file) {
+  return _fcd_file->state == FCD_STATE_OLD || _fcd_file->state == FCD_STATE_DEL || _fcd_file->state == FCD_STATE_ERR;
+}
+
+//  the last check was OK - the stat() signature may skip reading it after the next start
+static int fcd_etadb_verified(struct FCD_FILE *_fcd_file) {
+  return _fcd_file->state == FCD_STATE_OLD && !_fcd_file->partial &&
+         !memcmp(fcd_file_next(_fcd_file), fcd_file_original(_fcd_file), fcd_digest->size);
+}
+
+/*
+ * int fcd_etadb_save( struct FCD_ETALON *etalon, const char *file, const char *path, uint32_t flags,
+ *                     uint64_t chunk, const char **errop );
+ *
+ * The function fcd_etadb_save() writes the entries of the etalon list (with
+ * block digests of chunk bytes) to file atomically, the stat() signature only
+ * of the files verified OK.
+ * Returns 0 or errno (errop - the failed operation).
+ */
+int fcd_etadb_save(struct FCD_ETALON *_etalon, const char *_file, const char *_path, uint32_t _flags,
+                   uint64_t _chunk, const char **_errop) {
+  int cc = 0;
+  struct FCD_ETADB_HEADER header;
+  struct FCD_ETADB_RECORD record;
+  struct FCD_ETADB_BLOCK block;
+  size_t path_len = strlen(_path), used = 0;
+  char tmp[strlen(_file) + 8];
+  snprintf(tmp, sizeof(tmp), "%s.tmp", _file);
+  *_errop = NULL;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, FCD_ETADB_MAGIC, sizeof(header.magic));
+  header.version = FCD_ETADB_VERSION;
+  header.flags = _flags;
+  header.path_len = path_len;
+  header.names_size = path_len + 1;
+  header.created = time(NULL);
+  header.chunk = _chunk;
+  for (size_t n = 0; n < _etalon->count; ++n) {
+    struct FCD_FILE *fcd_file = fcd_etalon_file(_etalon, n);
+    if (!fcd_etadb_kept(fcd_file)) continue;
+    ++header.count;
+    header.names_size += strlen(fcd_file->name) + 1;
+    if (fcd_file->blocks) header.blocks += fcd_file->blocks->original_count;
+  }
+  int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    *_errop = "open";
+    return errno;
+  }
+  unsigned char *buff = my_malloc(FCD_ETADB_BUFF);
+  uint32_t crc = crc32_start();
+  //  the header is written last, when the checksum is known
+  if (lseek(fd, sizeof(header), SEEK_SET) < 0) {
+    *_errop = "lseek";
+    cc = errno;
+  }
+  //  records, block digests, then names
+  uint64_t name_offset = path_len + 1;
+  for (size_t n = 0; !cc && n < _etalon->count; ++n) {
+    struct FCD_FILE *fcd_file = fcd_etalon_file(_etalon, n);
+    if (!fcd_etadb_kept(fcd_file)) continue;
+    memset(&record, 0, sizeof(record));
+    record.name_len = strlen(fcd_file->name);
+    record.name_hash = fcd_name_hash(fcd_file->name, record.name_len);
+    record.name_offset = name_offset;
+    memcpy(record.digest, fcd_file_original(fcd_file), fcd_digest->size);
+    record.blocks = fcd_file->blocks ? fcd_file->blocks->original_count : 0;
+    if (fcd_etadb_verified(fcd_file)) {
+      record.dev = fcd_file->sig.dev;
+      record.ino = fcd_file->sig.ino;
+      record.size = fcd_file->sig.size;
+      record.mtime_ns = fcd_file->sig.mtime_ns;
+      record.ctime_ns = fcd_file->sig.ctime_ns;
+    }
+    name_offset += record.name_len + 1;
+    cc = fcd_etadb_put(fd, buff, &used, &record, sizeof(record), &crc);
+  }
+  for (size_t n = 0; !cc && n < _etalon->count; ++n) {
+    struct FCD_FILE *fcd_file = fcd_etalon_file(_etalon, n);
+    if (!fcd_etadb_kept(fcd_file) || !fcd_file->blocks) continue;
+    for (size_t i = 0; !cc && i < fcd_file->blocks->original_count; ++i) {
+      memcpy(block.digest, fcd_file->blocks->original[i].value, sizeof(block.digest));
+      block.bytes = fcd_file->blocks->original[i].bytes;
+      cc = fcd_etadb_put(fd, buff, &used, &block, sizeof(block), &crc);
+    }
+  }
+  if (!cc) cc = fcd_etadb_put(fd, buff, &used, _path, path_len + 1, &crc);
+  for (size_t n = 0; !cc && n < _etalon->count; ++n) {
+    struct FCD_FILE *fcd_file = fcd_etalon_file(_etalon, n);
+    if (!fcd_etadb_kept(fcd_file)) continue;
+    cc = fcd_etadb_put(fd, buff, &used, fcd_file->name, strlen(fcd_file->name) + 1, &crc);
+  }
+  if (!cc) cc = fcd_etadb_write(fd, buff, used, &crc);
+  free(buff);
+  if (cc && !*_errop) *_errop = "write";
+  if (!cc) {
+    header.checksum = crc32_finish(crc);
+    ssize_t wl = pwrite(fd, &header, sizeof(header), 0);
+    if (wl != sizeof(header)) {
+      *_errop = "pwrite";
+      cc = wl < 0 ? errno : EIO;
+    }
+  }
+  if (!cc && fsync(fd)) {
+    *_errop = "fsync";
+    cc = errno;
+  }
+  if (close(fd) && !cc) {
+    *_errop = "close";
+    cc = errno;
+  }
+  if (!cc && rename(tmp, _file)) {
+    *_errop = "rename";
+    cc = errno;
+  }
+  if (cc) unlink(tmp);
+  return cc;
+}
+
+/*
+ * int fcd_etadb_load( struct FCD_ETALON *etalon, const char *file, const char *path, uint32_t flags,
+ *                     uint64_t chunk, const char **errop );
+ *
+ * The function fcd_etadb_load() fills the empty etalon list from file (state
+ * OLD, source metadata), block digests - only if they are of chunk bytes.
+ * Returns 0, ENOENT (no file), EBADMSG (corrupted or modified file), EINVAL
+ * (file of another mission) or errno.
+ */
+int fcd_etadb_load(struct FCD_ETALON *_etalon, const char *_file, const char *_path, uint32_t _flags,
+                   uint64_t _chunk, const char **_errop) {
+  struct stat st;
+  int fd = open(_file, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    *_errop = "open";
+    return errno;
+  }
+  if (fstat(fd, &st)) {
+    int cc = errno;
+    close(fd);
+    *_errop = "fstat";
+    return cc;
+  }
+  if ((size_t)st.st_size < sizeof(struct FCD_ETADB_HEADER)) {
+    close(fd);
+    *_errop = "header";
+    return EBADMSG;
+  }
+  //  the mapping stays for the lifetime of the process - names point into it
+  const unsigned char *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    *_errop = "mmap";
+    return errno;
+  }
+  madvise((void *)map, st.st_size, MADV_SEQUENTIAL);
+  const struct FCD_ETADB_HEADER *header = (const struct FCD_ETADB_HEADER *)map;
+  uint64_t body = st.st_size - sizeof(struct FCD_ETADB_HEADER);
+  if (memcmp(header->magic, FCD_ETADB_MAGIC, sizeof(header->magic)) || header->version != FCD_ETADB_VERSION ||
+      header->count > body / sizeof(struct FCD_ETADB_RECORD) ||
+      header->blocks > (body - header->count * sizeof(struct FCD_ETADB_RECORD)) / sizeof(struct FCD_ETADB_BLOCK) ||
+      header->names_size != body - header->count * sizeof(struct FCD_ETADB_RECORD) -
+                            header->blocks * sizeof(struct FCD_ETADB_BLOCK) ||
+      header->path_len >= header->names_size) {
+    munmap((void *)map, st.st_size);
+    *_errop = "header";
+    return EBADMSG;
+  }
+  if (crc32_finish(crc32_update_block(crc32_start(), header + 1, body)) != header->checksum) {
+    munmap((void *)map, st.st_size);
+    *_errop = "checksum";
+    return EBADMSG;
+  }
+  const struct FCD_ETADB_RECORD *records = (const struct FCD_ETADB_RECORD *)(header + 1);
+  const struct FCD_ETADB_BLOCK *blocks = (const struct FCD_ETADB_BLOCK *)(records + header->count);
+  const char *names = (const char *)(blocks + header->blocks);
+  if (header->flags != _flags || header->path_len != strlen(_path) || memcmp(names, _path, header->path_len + 1)) {
+    munmap((void *)map, st.st_size);
+    *_errop = "mission";
+    return EINVAL;
+  }
+  //  all records are checked first - a bad one leaves the etalon list empty
+  uint64_t block_first = 0;
+  for (uint64_t n = 0; n < header->count; ++n) {
+    const struct FCD_ETADB_RECORD *record = &records[n];
+    if (record->name_offset >= header->names_size || record->name_len >= header->names_size - record->name_offset ||
+        names[record->name_offset + record->name_len] || record->blocks > header->blocks - block_first) {
+      munmap((void *)map, st.st_size);
+      *_errop = "record";
+      return EBADMSG;
+    }
+    block_first += record->blocks;
+  }
+  block_first = 0;
+  for (uint64_t n = 0; n < header->count; ++n) {
+    const struct FCD_ETADB_RECORD *record = &records[n];
+    struct FCD_FILE *fcd_file = fcd_etalon_append_name(_etalon, names + record->name_offset, record->name_len,
+                                                       record->name_hash);
+    fcd_file->state = FCD_STATE_OLD;
+    memcpy(fcd_file_original(fcd_file), record->digest, fcd_digest->size);
+    memcpy(fcd_file_next(fcd_file), record->digest, fcd_digest->size);
+    fcd_file->source = FCD_SOURCE_METADATA;
+    //  st_dev folded to 32 bits - as fcd_stat_sig() makes it
+    fcd_file->sig.dev = fcd_stat_dev(record->dev);
+    fcd_file->sig.ino = record->ino;
+    fcd_file->sig.size = record->size;
+    fcd_file->sig.mtime_ns = record->mtime_ns;
+    fcd_file->sig.ctime_ns = record->ctime_ns;
+    //  block digests are copied - the etalon may grow (verify=append)
+    if (record->blocks && _chunk && header->chunk == _chunk) {
+      fcd_file->blocks = my_malloc(sizeof(struct FCD_BLOCKS));
+      fcd_file->blocks->original_count = fcd_file->blocks->next_count = record->blocks;
+      fcd_file->blocks->original = my_malloc(sizeof(struct FCD_DIGEST_PART) * record->blocks);
+      fcd_file->blocks->next = my_malloc(sizeof(struct FCD_DIGEST_PART) * record->blocks);
+      for (uint32_t i = 0; i < record->blocks; ++i) {
+        memcpy(fcd_file->blocks->original[i].value, blocks[block_first + i].digest, FCD_DIGEST_MAX);
+        fcd_file->blocks->original[i].bytes = blocks[block_first + i].bytes;
+      }
+      memcpy(fcd_file->blocks->next, fcd_file->blocks->original, sizeof(struct FCD_DIGEST_PART) * record->blocks);
+    }
+    block_first += record->blocks;
+  }
+  return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ *  File Check Daemon - эталонный список на диске
+ *
+ *  Файл отображается mmap() целиком, имена эталонного списка указывают прямо
+ *  в отображение (без копирования). Формат (порядок байт - машинный):
+ *  - заголовок FCD_ETADB_HEADER (сигнатура, версия, CRC-32 всего остального)
+ *  - count записей FCD_ETADB_RECORD по 96 байт (контрольная сумма - байты
+ *    алгоритма миссии, номер алгоритма - в битах 8..15 flags)
+ *  - blocks сумм блоков FCD_ETADB_BLOCK по 40 байт, по порядку записей (у записи -
+ *    число её блоков), размер блока - chunk; другой chunk - суммы блоков не загружаются
+ *  - область имён: путь миссии и имена файлов, каждое с '\0' на конце
+ *
+ *  Записывается во временный файл рядом и переименовывается поверх (rename()).
+ */
+#ifndef FICHEDA_ETADB_H
+#define FICHEDA_ETADB_H
+
+#include <stdint.h>
+#include "etalon.h"
+
+#define FCD_ETADB_MAGIC       "FCDETADB"
+#define FCD_ETADB_VERSION     3
+#define FCD_ETADB_RECURSIVE   1
+#define FCD_ETADB_ALGORITHM   8
+
+struct FCD_ETADB_HEADER {
+    char magic[8];
+    uint32_t version;
+    uint32_t checksum;
+    uint32_t flags;
+    uint32_t path_len;
+    uint64_t count;
+    uint64_t names_size;
+    int64_t created;
+    uint64_t chunk;
+    uint64_t blocks;
+};
+
+struct FCD_ETADB_RECORD {
+    uint64_t name_hash;
+    uint64_t name_offset;
+    uint32_t name_len;
+    uint32_t blocks;
+    uint64_t dev;
+    uint64_t ino;
+    int64_t size;
+    int64_t mtime_ns;
+    int64_t ctime_ns;
+    unsigned char digest[FCD_DIGEST_MAX];
+};
+
+struct FCD_ETADB_BLOCK {
+    unsigned char digest[FCD_DIGEST_MAX];
+    uint64_t bytes;
+};
+
+int fcd_etadb_load(struct FCD_ETALON *_etalon, const char *_file, const char *_path, uint32_t _flags,
+                   uint64_t _chunk, const char **_errop);
+int fcd_etadb_save(struct FCD_ETALON *_etalon, const char *_file, const char *_path, uint32_t _flags,
+                   uint64_t _chunk, const char **_errop);
+
+#endif //FICHEDA_ETADB_H
@@ -0,0 +1,180 @@
+/*
+ *  File Check Daemon - эталонный список файлов
+ */
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "etalon.h"
+#include "ficheda.h"
+
+#define FCD_ETALON_MIN    64
+
+/*
+ * uint64_t fcd_name_hash( const char *name, size_t len );
+ *
+ * The function fcd_name_hash() returns 64-bit FNV-1a hash of the file name
+ */
+uint64_t fcd_name_hash(const char *_name, size_t _len) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < _len; ++i) {
+    hash ^= (unsigned char)_name[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}  /* fcd_name_hash */
+
+//  st_dev folded to 32 bits (major and minor of a usual device fit as is)
+uint32_t fcd_stat_dev(dev_t _dev) {
+  return (uint32_t)_dev ^ (uint32_t)((uint64_t)_dev >> 32);
+}
+
+/*
+ *  подпись stat(): если она не изменилась, содержимое считается прежним
+ */
+void fcd_stat_sig(struct FCD_STAT *_sig, const struct stat *_st) {
+  _sig->dev = fcd_stat_dev(_st->st_dev);
+  _sig->ino = _st->st_ino;
+  _sig->size = _st->st_size;
+  _sig->mtime_ns = (int64_t)_st->st_mtim.tv_sec * 1000000000 + _st->st_mtim.tv_nsec;
+  _sig->ctime_ns = (int64_t)_st->st_ctim.tv_sec * 1000000000 + _st->st_ctim.tv_nsec;
+}
+
+int fcd_stat_equal(const struct FCD_STAT *_sig, const struct stat *_st) {
+  struct FCD_STAT sig;
+  fcd_stat_sig(&sig, _st);
+  return sig.dev == _sig->dev && sig.ino == _sig->ino && sig.size == _sig->size &&
+         sig.mtime_ns == _sig->mtime_ns && sig.ctime_ns == _sig->ctime_ns;
+}
+
+static void fcd_etalon_slot_put(struct FCD_ETALON *_etalon, uint64_t _hash, size_t _index) {
+  size_t i = _hash & _etalon->slots_mask;
+  while (_etalon->slots[i]) i = (i + 1) & _etalon->slots_mask;
+  _etalon->slots[i] = (_hash >> 32) << 32 | (_index + 1);
+}
+
+static void fcd_etalon_grow(struct FCD_ETALON *_etalon) {
+  size_t capacity = _etalon->capacity + FCD_ETALON_PAGE;
+  //  the record stride - the digests of the mission algorithm after the fields
+  if (!_etalon->stride)
+    _etalon->stride = (offsetof(struct FCD_FILE, digests) + 2 * fcd_digest->size +
+                       (_etalon->verified ? sizeof(uint32_t) : 0) + 7) & ~(size_t)7;
+  //  a new page, the records already given out stay in place
+  unsigned char **pages = my_malloc(sizeof(unsigned char *) * (_etalon->pages_count + 1));
+  if (_etalon->pages_count) memcpy(pages, _etalon->pages, sizeof(unsigned char *) * _etalon->pages_count);
+  pages[_etalon->pages_count++] = my_malloc(_etalon->stride * FCD_ETALON_PAGE);
+  free(_etalon->pages);
+  _etalon->pages = pages;
+  //  seen bitmap
+  uint64_t *seen = my_malloc(sizeof(uint64_t) * (capacity / 64));
+  memset(seen, 0, sizeof(uint64_t) * (capacity / 64));
+  if (_etalon->capacity) memcpy(seen, _etalon->seen, sizeof(uint64_t) * (_etalon->capacity / 64));
+  free(_etalon->seen);
+  _etalon->seen = seen;
+  _etalon->capacity = capacity;
+  //  hash slots (load factor <= 0.5), hashes again from the names
+  if (capacity * 2 <= _etalon->slots_mask + 1) return;
+  size_t slots = _etalon->slots_mask ? (_etalon->slots_mask + 1) * 2 : FCD_ETALON_MIN;
+  while (slots < capacity * 2) slots *= 2;
+  free(_etalon->slots);
+  _etalon->slots_mask = slots - 1;
+  _etalon->slots = my_malloc(sizeof(uint64_t) * slots);
+  memset(_etalon->slots, 0, sizeof(uint64_t) * slots);
+  for (size_t n = 0; n < _etalon->count; ++n) {
+    const char *name = fcd_etalon_file(_etalon, n)->name;
+    fcd_etalon_slot_put(_etalon, fcd_name_hash(name, strlen(name)), n);
+  }
+}
+
+//  a copy of the name in the arena (a long name - its own block)
+static const char *fcd_etalon_name(struct FCD_ETALON *_etalon, const char *_name, size_t _len) {
+  char *name;
+  if (_len + 1 > FCD_ETALON_ARENA / 16) {
+    name = my_malloc(_len + 1);
+  } else {
+    if (_etalon->arena_left < _len + 1) {
+      _etalon->arena = my_malloc(FCD_ETALON_ARENA);
+      _etalon->arena_left = FCD_ETALON_ARENA;
+    }
+    name = _etalon->arena;
+    _etalon->arena += _len + 1;
+    _etalon->arena_left -= _len + 1;
+  }
+  memcpy(name, _name, _len + 1);
+  return name;
+}
+
+struct FCD_FILE *fcd_etalon_append(struct FCD_ETALON *_etalon, const char *_name) {
+  size_t len = strlen(_name);
+  return fcd_etalon_append_name(_etalon, fcd_etalon_name(_etalon, _name, len), len, fcd_name_hash(_name, len));
+}
+
+/*
+ *  имя не копируется (должно жить всё время работы), хэш уже посчитан
+ */
+struct FCD_FILE *fcd_etalon_append_name(struct FCD_ETALON *_etalon, const char *_name, size_t _len, uint64_t _hash) {
+  if (_etalon->count == _etalon->capacity) fcd_etalon_grow(_etalon);
+  //  fill new item
+  struct FCD_FILE *fcd_file = fcd_etalon_file(_etalon, _etalon->count);
+  memset(fcd_file, 0, _etalon->stride);
+  fcd_file->state = FCD_STATE_NEW;
+  fcd_file->name = _name;
+  fcd_file->index = _etalon->count;
+  fcd_file->source = FCD_SOURCE_CONTENT;
+  //  index item
+  fcd_etalon_slot_put(_etalon, _hash, _etalon->count++);
+  _etalon->names_size += _len + 1;
+  return fcd_file;
+}
+
+struct FCD_FILE *fcd_etalon_find(struct FCD_ETALON *_etalon, const char *_name) {
+  if (!_etalon->count) return NULL;
+  uint64_t hash = fcd_name_hash(_name, strlen(_name)), slot;
+  struct FCD_FILE *fcd_file;
+  for (size_t i = hash & _etalon->slots_mask; (slot = _etalon->slots[i]); i = (i + 1) & _etalon->slots_mask) {
+    if (slot >> 32 != hash >> 32) continue;
+    fcd_file = fcd_etalon_file(_etalon, (slot & 0xFFFFFFFFu) - 1);
+    if (strcmp(fcd_file->name, _name) == 0) return fcd_file;
+  }
+  return NULL;
+}
+
+//  memory of the list: records, hash slots, seen bitmap and names (without block digests)
+size_t fcd_etalon_bytes(struct FCD_ETALON *_etalon) {
+  if (!_etalon->capacity) return 0;
+  return _etalon->stride * _etalon->capacity + sizeof(uint64_t) * (_etalon->slots_mask + 1) +
+         _etalon->capacity / 8 + _etalon->names_size;
+}
+
+void fcd_etalon_seen_reset(struct FCD_ETALON *_etalon) {
+  if (_etalon->capacity) memset(_etalon->seen, 0, sizeof(uint64_t) * (_etalon->capacity / 64));
+  _etalon->seen_count = 0;
+}
+
+/*
+ *  возвращает 1, если файл встречен впервые в текущем сканировании
+ */
+int fcd_etalon_seen_mark(struct FCD_ETALON *_etalon, struct FCD_FILE *_fcd_file) {
+  uint64_t bit = 1ull << (_fcd_file->index & 63);
+  uint64_t *word = &_etalon->seen[_fcd_file->index / 64];
+  if (*word & bit) return 0;
+  *word |= bit;
+  ++_etalon->seen_count;
+  return 1;
+}
+
+/*
+ *  следующий не встреченный в текущем сканировании файл, начиная с *_pos
+ */
+struct FCD_FILE *fcd_etalon_next_unseen(struct FCD_ETALON *_etalon, size_t *_pos) {
+  if (_etalon->seen_count == _etalon->count) return NULL;
+  for (size_t w = *_pos / 64; w * 64 < _etalon->count; ++w) {
+    uint64_t unseen = ~_etalon->seen[w];
+    if (w == *_pos / 64) unseen &= ~0ull << (*_pos & 63);
+    if (!unseen) continue;
+    size_t n = w * 64 + __builtin_ctzll(unseen);
+    if (n >= _etalon->count) return NULL;
+    *_pos = n + 1;
+    return fcd_etalon_file(_etalon, n);
+  }
+  return NULL;
+}
@@ -0,0 +1,124 @@
+/*
+ *  File Check Daemon - эталонный список файлов
+ *
+ *  - записи подряд, страницами по FCD_ETALON_PAGE записей (адрес записи не меняется,
+ *    пока список растёт), номер записи (index) - страница и место в ней
+ *  - запись - около 64 байт: горячие поля (состояние, подпись stat(), номер) и
+ *    контрольные суммы эталона и последнего расчёта сразу за ними, размером алгоритма
+ *    миссии (fcd_file_original(), fcd_file_next()); без указателей на потоки и списков
+ *  - имена - в общей области (arena) блоками по FCD_ETALON_ARENA байт, с '\0' на конце,
+ *    не освобождаются; имена из файла etalon указывают прямо в его отображение
+ *  - поиск по имени - хэш-таблица с открытой адресацией: ячейка - 32 бита хэша
+ *    имени (FNV-1a) и номер записи, имя сравнивается только при совпадении хэша;
+ *    при росте таблицы хэши считаются заново по именам
+ *  - признак "файл встречен в текущем сканировании" - битовая карта
+ *  - подпись stat() на момент последнего расчёта (dev, ino, size, mtime, ctime)
+ *  - состояние файла хранится в записи, отчёт строится по всему списку:
+ *    NEW - первичный расчёт, OLD - рассчитан, ERR - ошибка чтения,
+ *    DEL - эталонный файл удалён, ADD - файл не из эталона (NEW в отчёте),
+ *    GONE - файл не из эталона, уже удалён
+ *  - статус в последнем отчёте (reported) - для журнала изменений
+ *  - контрольная сумма эталона и последнего расчёта - байты алгоритма миссии (digest.h)
+ *  - у файлов от blocks байт - ещё суммы блоков по chunk байт (части split) эталона и
+ *    последнего расчёта: по ним в отчёте диапазоны изменений, рост файла досчитывается
+ *    с последнего блока (verify=append), проверка прерывается на первом отличии (early)
+ *  - со скользящей проверкой (verified) - ещё время последней проверки файла целиком,
+ *    после контрольных сумм: запись длиннее на 4 байта (с выравниванием - до 8)
+ */
+#ifndef FICHEDA_ETALON_H
+#define FICHEDA_ETALON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "digest.h"
+
+#define FCD_ETALON_PAGE       4096
+#define FCD_ETALON_ARENA      (1024 * 1024)
+
+//  dev - 32 bits of st_dev (fcd_stat_dev()), the signature packs into 36 bytes
+struct FCD_STAT {
+    uint64_t ino;
+    int64_t size;
+    int64_t mtime_ns;
+    int64_t ctime_ns;
+    uint32_t dev;
+} __attribute__((packed, aligned(4)));
+
+//  block i - [i * chunk, i * chunk + bytes); a block skipped by early verification - bytes FCD_BLOCK_SKIPPED
+#define FCD_BLOCK_SKIPPED     UINT64_MAX
+
+struct FCD_BLOCKS {
+    size_t original_count;
+    struct FCD_DIGEST_PART *original;
+    size_t next_count;
+    struct FCD_DIGEST_PART *next;
+};
+
+enum {FCD_STATE_NEW, FCD_STATE_OLD, FCD_STATE_ERR, FCD_STATE_DEL, FCD_STATE_ADD, FCD_STATE_GONE};
+enum {FCD_SOURCE_CONTENT, FCD_SOURCE_METADATA};
+
+//  the record is followed by the digests: etalon, then last calculation (fcd_digest->size each)
+struct FCD_FILE {
+    const char *name;
+    struct FCD_BLOCKS *blocks;
+    struct FCD_STAT sig;
+    uint32_t index;
+    uint16_t errnum;
+    unsigned char state;
+    unsigned char source;
+    unsigned char reported;
+    unsigned char partial;
+    unsigned char digests[];
+};
+
+#define fcd_file_original(_fcd_file)  ((_fcd_file)->digests)
+#define fcd_file_next(_fcd_file)      ((_fcd_file)->digests + fcd_digest->size)
+
+//  Unix time after the digests (not aligned), 0 - not known; only in a list with verified
+static inline uint32_t fcd_file_verified(const struct FCD_FILE *_fcd_file) {
+  uint32_t time;
+  memcpy(&time, _fcd_file->digests + 2 * fcd_digest->size, sizeof(time));
+  return time;
+}
+
+static inline void fcd_file_verified_set(struct FCD_FILE *_fcd_file, uint32_t _time) {
+  memcpy(_fcd_file->digests + 2 * fcd_digest->size, &_time, sizeof(_time));
+}
+
+struct FCD_ETALON {
+    unsigned char **pages;
+    size_t pages_count;
+    size_t stride;
+    size_t count;
+    size_t capacity;
+    //  hash slot: 32 bits of the name hash << 32 | index + 1, 0 - empty
+    uint64_t *slots;
+    size_t slots_mask;
+    char *arena;
+    size_t arena_left;
+    size_t names_size;
+    uint64_t *seen;
+    size_t seen_count;
+    //  the records carry the time of the last whole verification (rolling)
+    int verified;
+};
+
+static inline struct FCD_FILE *fcd_etalon_file(struct FCD_ETALON *_etalon, size_t _n) {
+  return (struct FCD_FILE *)(_etalon->pages[_n / FCD_ETALON_PAGE] + _n % FCD_ETALON_PAGE * _etalon->stride);
+}
+
+uint64_t fcd_name_hash(const char *_name, size_t _len);
+uint32_t fcd_stat_dev(dev_t _dev);
+void fcd_stat_sig(struct FCD_STAT *_sig, const struct stat *_st);
+int fcd_stat_equal(const struct FCD_STAT *_sig, const struct stat *_st);
+struct FCD_FILE *fcd_etalon_append(struct FCD_ETALON *_etalon, const char *_name);
+struct FCD_FILE *fcd_etalon_append_name(struct FCD_ETALON *_etalon, const char *_name, size_t _len, uint64_t _hash);
+struct FCD_FILE *fcd_etalon_find(struct FCD_ETALON *_etalon, const char *_name);
+size_t fcd_etalon_bytes(struct FCD_ETALON *_etalon);
+void fcd_etalon_seen_reset(struct FCD_ETALON *_etalon);
+int fcd_etalon_seen_mark(struct FCD_ETALON *_etalon, struct FCD_FILE *_fcd_file);
+struct FCD_FILE *fcd_etalon_next_unseen(struct FCD_ETALON *_etalon, size_t *_pos);
+
+#endif //FICHEDA_ETALON_H
@@ -0,0 +1,58 @@
+/*
+ *  File Check Daemon - общие служебные функции
+ */
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include "ficheda.h"
+
+void severe_error_0(const char* _errt, int _errc) {
+  const int strerrs = 1024;
+  char* strerrt = my_malloc(strerrs);
+  strerror_r(_errc, strerrt, strerrs);
+  syslog(LOG_ERR, "%s: [%i][%s]", _errt, _errc, strerrt);
+  exit(EXIT_FAILURE);
+}
+
+void severe_error_1(const char* _errt) {
+  syslog(LOG_ERR, "%s", _errt);
+  exit(EXIT_FAILURE);
+}
+
+void severe_error_2(const char* _path, const char* _errf, const char* _errt, int _errc) {
+  const int strerrs = 1024;
+  char* strerrt = my_malloc(strerrs);
+  strerror_r(_errc, strerrt, strerrs);
+  syslog(LOG_WARNING, "Initial calculation: FAIL (%s/%s - %s: [%i] %s)", _path, _errf, _errt, _errc, strerrt);
+  exit(EXIT_FAILURE);
+}
+
+void severe_error_3(const char* _errt, int _i1, int _i2) {
+  syslog(LOG_ERR, _errt, _i1, _i2);
+  exit(EXIT_FAILURE);
+}
+
+void light_error_0(const char* _path, const char* _errf, const char* _errt, int _errc) {
+  char strerrt[1024];
+  strerror_r(_errc, strerrt, sizeof(strerrt));
+  syslog(LOG_WARNING, "Integrity check: FAIL (%s/%s - %s: [%i] %s)", _path, _errf, _errt, _errc, strerrt);
+}
+
+void *my_malloc(size_t _size) {
+  void *ptr = malloc(_size);
+  if (!ptr) {
+    syslog(LOG_ERR, "Out of memory!!!");
+    raise(SIGTERM);
+  }
+  return ptr;
+}
+
+char *my_strdup(char *_str) {
+  char *ptr = strdup(_str);
+  if (!ptr) {
+    syslog(LOG_ERR, "Out of memory!!!");
+    raise(SIGTERM);
+  }
+  return ptr;
+}
@@ -0,0 +1,17 @@
+/*
+ *  File Check Daemon - общие служебные функции
+ */
+#ifndef FICHEDA_H
+#define FICHEDA_H
+
+#include <stddef.h>
+
+void *my_malloc(size_t _size);
+char *my_strdup(char *_str);
+void severe_error_0(const char* _errt, int _errc);
+void severe_error_1(const char* _errt);
+void severe_error_2(const char* _path, const char* _errf, const char* _errt, int _errc);
+void severe_error_3(const char* _errt, int _i1, int _i2);
+void light_error_0(const char* _path, const char* _errf, const char* _errt, int _errc);
+
+#endif //FICHEDA_H
@@ -0,0 +1,203 @@
+/*
+ *  File Check Daemon - запись JSON-файла отчёта
+ *
+ *  Буфер сбрасывается в файл, только когда следующий фрагмент не помещается,
+ *  поэтому длинные строки экранируются по частям, а в файл уходят блоки
+ *  по FCD_JSON_BUFF байт.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ficheda.h"
+#include "json.h"
+
+static const char fcd_json_digits[] = "0123456789ABCDEF";
+
+//  suffix names the neighbour file: ".tmp" for the report, ".1" for the rotated log
+void fcd_json_init(struct FCD_JSON *_json, const char *_path, const char *_suffix) {
+  size_t len = strlen(_path), suffix_len = strlen(_suffix);
+  _json->buff = my_malloc(FCD_JSON_BUFF);
+  _json->len = 0;
+  _json->fd = -1;
+  _json->size = 0;
+  _json->path = _path;
+  _json->send_flags = 0;
+  _json->errnum = 0;
+  _json->path_aux = my_malloc(len + suffix_len + 1);
+  memcpy(_json->path_aux, _path, len);
+  memcpy(_json->path_aux + len, _suffix, suffix_len + 1);
+}
+
+static void fcd_json_flush(struct FCD_JSON *_json) {
+  const char *p = _json->buff;
+  size_t left = _json->len;
+  if (!_json->path) {
+    //  the socket stream - the client may be gone, the daemon goes on
+    while (left && !_json->errnum) {
+      ssize_t rc = send(_json->fd, p, left, MSG_NOSIGNAL | _json->send_flags);
+      if (rc < 0 && errno != EINTR) _json->errnum = errno;
+      if (rc > 0) {
+        p += rc;
+        left -= rc;
+      }
+    }
+    _json->len = 0;
+    return;
+  }
+  while (left) {
+    ssize_t rc = write(_json->fd, p, left);
+    if (rc < 0) {
+      if (errno == EINTR) continue;
+      severe_error_0("write(mission_json)", errno);
+    }
+    p += rc;
+    left -= rc;
+  }
+  _json->size += _json->len;
+  _json->len = 0;
+}
+
+void fcd_json_open(struct FCD_JSON *_json) {
+  //  the same permissions as the report created by fopen()
+  _json->fd = open(_json->path_aux, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (_json->fd < 0) severe_error_0("open(mission_json)", errno);
+  _json->len = 0;
+  _json->size = 0;
+}
+
+void fcd_json_put(struct FCD_JSON *_json, const char *_str, size_t _len) {
+  while (_len) {
+    if (_json->len == FCD_JSON_BUFF) fcd_json_flush(_json);
+    size_t n = FCD_JSON_BUFF - _json->len;
+    if (n > _len) n = _len;
+    memcpy(_json->buff + _json->len, _str, n);
+    _json->len += n;
+    _str += n;
+    _len -= n;
+  }
+}
+
+/*
+ * void fcd_json_string( struct FCD_JSON *json, const char *str );
+ *
+ * The function fcd_json_string() appends str escaped as the body of a JSON
+ * string: quote, backslash and control characters; other bytes (UTF-8 names)
+ * go as is.
+ */
+void fcd_json_string(struct FCD_JSON *_json, const char *_str) {
+  const unsigned char *s = (const unsigned char *)_str;
+  while (*s) {
+    //  the longest run without escaping is copied at once
+    const unsigned char *run = s;
+    while (*s >= 0x20 && *s != '"' && *s != '\\') ++s;
+    if (s != run) fcd_json_put(_json, (const char *)run, s - run);
+    if (!*s) break;
+    if (FCD_JSON_BUFF - _json->len < 6) fcd_json_flush(_json);
+    char *out = _json->buff + _json->len;
+    *out++ = '\\';
+    switch (*s) {
+      case '"': *out++ = '"'; break;
+      case '\\': *out++ = '\\'; break;
+      case '\b': *out++ = 'b'; break;
+      case '\f': *out++ = 'f'; break;
+      case '\n': *out++ = 'n'; break;
+      case '\r': *out++ = 'r'; break;
+      case '\t': *out++ = 't'; break;
+      default:
+        *out++ = 'u';
+        *out++ = '0';
+        *out++ = '0';
+        *out++ = fcd_json_digits[*s >> 4];
+        *out++ = fcd_json_digits[*s & 15];
+        break;
+    }
+    _json->len = out - _json->buff;
+    ++s;
+  }
+}
+
+void fcd_json_uint64(struct FCD_JSON *_json, uint64_t _value) {
+  char digits[20];
+  int n = 0;
+  do digits[n++] = '0' + _value % 10; while ((_value /= 10));
+  if (FCD_JSON_BUFF - _json->len < (size_t)n) fcd_json_flush(_json);
+  while (n) _json->buff[_json->len++] = digits[--n];
+}
+
+/*
+ * void fcd_json_commit( struct FCD_JSON *json );
+ *
+ * The function fcd_json_commit() writes the rest of the buffer, closes
+ * the temporary file and renames it over the report.
+ */
+void fcd_json_commit(struct FCD_JSON *_json) {
+  fcd_json_flush(_json);
+  if (close(_json->fd)) severe_error_0("close(mission_json)", errno);
+  _json->fd = -1;
+  if (rename(_json->path_aux, _json->path)) severe_error_0("rename(mission_json)", errno);
+}
+
+/*
+ * void fcd_json_log_open( struct FCD_JSON *json, long rotate );
+ *
+ * The function fcd_json_log_open() opens the log for appending if it is not
+ * open yet. If the log has grown to rotate bytes (0 - never), it is renamed
+ * to the ".1" file (the previous one is replaced) and a new log is started.
+ */
+void fcd_json_log_open(struct FCD_JSON *_json, long _rotate) {
+  struct stat st;
+  if (_json->fd >= 0 && _rotate && _json->size >= _rotate) {
+    if (close(_json->fd)) severe_error_0("close(mission_changes)", errno);
+    _json->fd = -1;
+    if (rename(_json->path, _json->path_aux)) severe_error_0("rename(mission_changes)", errno);
+  }
+  if (_json->fd >= 0) return;
+  _json->fd = open(_json->path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0666);
+  if (_json->fd < 0) severe_error_0("open(mission_changes)", errno);
+  if (fstat(_json->fd, &st)) severe_error_0("fstat(mission_changes)", errno);
+  _json->size = st.st_size;
+  _json->len = 0;
+  //  the log left by the previous run may be already full
+  if (_rotate && _json->size >= _rotate) fcd_json_log_open(_json, _rotate);
+}
+
+//  the log stays open for the next report
+void fcd_json_log_flush(struct FCD_JSON *_json) {
+  fcd_json_flush(_json);
+}
+
+/*
+ * void fcd_json_stream( struct FCD_JSON *json, int fd, int send_flags );
+ *
+ * The function fcd_json_stream() prepares the buffer for a connected socket:
+ * the text goes by send() with send_flags (MSG_DONTWAIT - a slow reader gets
+ * EAGAIN in errnum instead of blocking the writer).
+ */
+void fcd_json_stream(struct FCD_JSON *_json, int _fd, int _send_flags) {
+  _json->buff = my_malloc(FCD_JSON_BUFF);
+  _json->len = 0;
+  _json->fd = _fd;
+  _json->size = 0;
+  _json->path = NULL;
+  _json->path_aux = NULL;
+  _json->send_flags = _send_flags;
+  _json->errnum = 0;
+}
+
+//  the text of the stream so far goes to the socket, returns 0 or errno of the stream
+int fcd_json_send(struct FCD_JSON *_json) {
+  fcd_json_flush(_json);
+  return _json->errnum;
+}
+
+void fcd_json_free(struct FCD_JSON *_json) {
+  free(_json->buff);
+  free(_json->path_aux);
+  _json->buff = NULL;
+  _json->path_aux = NULL;
+}
@@ -0,0 +1,48 @@
+/*
+ *  File Check Daemon - запись JSON-файла отчёта
+ *
+ *  - текст формируется в большом буфере без printf(): шестнадцатеричные
+ *    числа и экранирование строк вручную, буфер пишется крупными write()
+ *  - строки любой длины экранируются прямо в буфер, без промежуточных копий
+ *  - отчёт пишется во временный файл рядом (json.tmp) и переименовывается
+ *    поверх (rename()) - читатель видит либо старый, либо новый отчёт целиком
+ *  - журнал изменений (NDJSON) дописывается в конец (O_APPEND), файл держится
+ *    открытым; при размере от rotate байт переименовывается в changes.1
+ *  - поток в сокет (control.c): ошибка записи не завершает демон, а остаётся в
+ *    errnum - клиент отключается, остальной текст для него отбрасывается
+ */
+#ifndef FICHEDA_JSON_H
+#define FICHEDA_JSON_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define FCD_JSON_BUFF     1048576
+
+struct FCD_JSON {
+    char *buff;
+    size_t len;
+    int fd;
+    off_t size;
+    const char *path;
+    char *path_aux;
+    int send_flags;
+    int errnum;
+};
+
+#define fcd_json_literal(_json, _str) fcd_json_put((_json), (_str), sizeof(_str) - 1)
+
+void fcd_json_init(struct FCD_JSON *_json, const char *_path, const char *_suffix);
+void fcd_json_open(struct FCD_JSON *_json);
+void fcd_json_put(struct FCD_JSON *_json, const char *_str, size_t _len);
+void fcd_json_string(struct FCD_JSON *_json, const char *_str);
+void fcd_json_uint64(struct FCD_JSON *_json, uint64_t _value);
+void fcd_json_commit(struct FCD_JSON *_json);
+void fcd_json_log_open(struct FCD_JSON *_json, long _rotate);
+void fcd_json_log_flush(struct FCD_JSON *_json);
+void fcd_json_stream(struct FCD_JSON *_json, int _fd, int _send_flags);
+int fcd_json_send(struct FCD_JSON *_json);
+void fcd_json_free(struct FCD_JSON *_json);
+
+#endif //FICHEDA_JSON_H
@@ -0,0 +1,212 @@
+/*
+ *  File Check Daemon - метрики работы
+ *
+ *  Владелец сегмента меняет значения обычными load/store (relaxed): писатель
+ *  у сегмента один, читатель видит значение целиком, пусть и чуть устаревшее.
+ */
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "ficheda.h"
+#include "metrics.h"
+#include "pool.h"
+
+struct FCD_METRICS_SHARD {
+    struct FCD_METRICS_SHARD *next;
+    uint64_t counters[FCD_METRICS_COUNTERS];
+    uint64_t buckets[FCD_METRICS_HISTOGRAMS][FCD_METRICS_BUCKETS + 1];
+    uint64_t sums[FCD_METRICS_HISTOGRAMS];
+} __attribute__((aligned(FCD_CACHE_LINE)));
+
+struct FCD_METRICS_INFO {
+    const char *name;
+    const char *help;
+    const char *type;
+    const char *labels;
+};
+
+static const struct FCD_METRICS_INFO fcd_metrics_counters[FCD_METRICS_COUNTERS] = {
+  {"ficheda_scans_total", "Scans by kind", "counter", "kind=\"full\""},
+  {"ficheda_scans_total", NULL, NULL, "kind=\"targeted\""},
+  {"ficheda_deep_scans_total", "Full scans with deep verification", "counter", NULL},
+  {"ficheda_files_total", "Calculated files by source of the result", "counter", "source=\"content\""},
+  {"ficheda_files_total", NULL, NULL, "source=\"metadata\""},
+  {"ficheda_files_total", NULL, NULL, "source=\"error\""},
+  {"ficheda_files_appended_total", "Files verified by the appended blocks only", "counter", NULL},
+  {"ficheda_parts_total", "Parts of split files", "counter", NULL},
+  {"ficheda_bytes_hashed_total", "Bytes read and hashed", "counter", NULL},
+  {"ficheda_wait_seconds_total", "Time spent waiting", "counter", "on=\"pool\""},
+  {"ficheda_wait_seconds_total", NULL, NULL, "on=\"io_rate\""},
+  {"ficheda_wait_seconds_total", NULL, NULL, "on=\"cpu\""},
+  {"ficheda_wait_seconds_total", NULL, NULL, "on=\"report_buffer\""},
+  {"ficheda_reports_total", "Reports written by JSON-writer (full or changes only)", "counter", "kind=\"changes\""},
+  {"ficheda_reports_total", NULL, NULL, "kind=\"full\""},
+  {"ficheda_changes_total", "Status changes of files (lines of the change log)", "counter", NULL}
+};
+
+static const struct FCD_METRICS_INFO fcd_metrics_histograms[FCD_METRICS_HISTOGRAMS] = {
+  {"ficheda_scan_seconds", "Scan duration (launcher)", "histogram", NULL},
+  {"ficheda_file_seconds", "Calculation time of a file read from disk (calculator)", "histogram", NULL},
+  {"ficheda_report_write_seconds", "Time to write a report (JSON-writer)", "histogram", NULL}
+};
+
+static const struct FCD_METRICS_INFO fcd_metrics_gauges[FCD_METRICS_GAUGES] = {
+  {"ficheda_etalon_files", "Files in the etalon list", "gauge", NULL},
+  {"ficheda_files", "Files by status in the last report", "gauge", "status=\"OK\""},
+  {"ficheda_files", NULL, NULL, "status=\"FAIL\""},
+  {"ficheda_files", NULL, NULL, "status=\"ERROR\""},
+  {"ficheda_files", NULL, NULL, "status=\"DELETED\""},
+  {"ficheda_files", NULL, NULL, "status=\"NEW\""},
+  {"ficheda_pool_queue_depth", "Jobs in the pool queue", "gauge", NULL},
+  {"ficheda_pool_pending_jobs", "Jobs submitted and not finished", "gauge", NULL},
+  {"ficheda_pool_threads", "Threads of the calculator pool", "gauge", NULL},
+  {"ficheda_concurrency", "Jobs of a mission at once, summed over the missions", "gauge", NULL},
+  {"ficheda_reports_pending", "Reports waiting for JSON-writer", "gauge", NULL},
+  {"ficheda_last_scan_timestamp_seconds", "End of the last scan (Unix time)", "gauge", NULL},
+  {"ficheda_rolling_covered_bytes", "Bytes of the etalon files verified in the rolling cycle so far", "gauge", NULL},
+  {"ficheda_rolling_total_bytes", "Bytes of the etalon files to verify in a rolling cycle", "gauge", NULL},
+  {"ficheda_verified_oldest_seconds", "Longest time since an etalon file was verified whole (rolling)", "gauge", NULL}
+};
+
+//  counters in nanoseconds are written as seconds
+static const int fcd_metrics_counters_ns[FCD_METRICS_COUNTERS] = {
+  [FCD_METRICS_POOL_WAIT_NS] = 1, [FCD_METRICS_IO_WAIT_NS] = 1, [FCD_METRICS_CPU_WAIT_NS] = 1,
+  [FCD_METRICS_REPORT_WAIT_NS] = 1
+};
+
+static pthread_mutex_t fcd_metrics_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct FCD_METRICS_SHARD *fcd_metrics_shards = NULL;
+static __thread struct FCD_METRICS_SHARD *fcd_metrics_shard = NULL;
+static int64_t fcd_metrics_values[FCD_METRICS_GAUGES];
+
+static struct FCD_METRICS_SHARD *fcd_metrics_own(void) {
+  if (fcd_metrics_shard) return fcd_metrics_shard;
+  struct FCD_METRICS_SHARD *shard = my_malloc(sizeof(struct FCD_METRICS_SHARD));
+  memset(shard, 0, sizeof(struct FCD_METRICS_SHARD));
+  //  lock mutex
+  if (pthread_mutex_lock(&fcd_metrics_mutex)) severe_error_0("pthread_mutex_lock(fcd_metrics_mutex)", errno);
+  shard->next = fcd_metrics_shards;
+  fcd_metrics_shards = shard;
+  //  unlock mutex
+  if (pthread_mutex_unlock(&fcd_metrics_mutex)) severe_error_0("pthread_mutex_unlock(fcd_metrics_mutex)", errno);
+  return fcd_metrics_shard = shard;
+}
+
+static inline void fcd_metrics_bump(uint64_t *_value, uint64_t _add) {
+  __atomic_store_n(_value, __atomic_load_n(_value, __ATOMIC_RELAXED) + _add, __ATOMIC_RELAXED);
+}
+
+void fcd_metrics_add(enum FCD_METRICS_COUNTER _counter, uint64_t _value) {
+  fcd_metrics_bump(&fcd_metrics_own()->counters[_counter], _value);
+}
+
+void fcd_metrics_observe(enum FCD_METRICS_HISTOGRAM _histogram, int64_t _ns) {
+  struct FCD_METRICS_SHARD *shard = fcd_metrics_own();
+  int bucket = 0;
+  if (_ns < 0) _ns = 0;
+  for (int64_t le = 1000000; bucket < FCD_METRICS_BUCKETS && _ns > le; le *= 4) ++bucket;
+  fcd_metrics_bump(&shard->buckets[_histogram][bucket], 1);
+  fcd_metrics_bump(&shard->sums[_histogram], _ns);
+}
+
+void fcd_metrics_set(enum FCD_METRICS_GAUGE _gauge, int64_t _value) {
+  __atomic_store_n(&fcd_metrics_values[_gauge], _value, __ATOMIC_RELAXED);
+}
+
+//  the counter summed over all threads
+uint64_t fcd_metrics_total(enum FCD_METRICS_COUNTER _counter) {
+  uint64_t total = 0;
+  //  lock mutex
+  if (pthread_mutex_lock(&fcd_metrics_mutex)) severe_error_0("pthread_mutex_lock(fcd_metrics_mutex)", errno);
+  for (struct FCD_METRICS_SHARD *shard = fcd_metrics_shards; shard; shard = shard->next)
+    total += __atomic_load_n(&shard->counters[_counter], __ATOMIC_RELAXED);
+  //  unlock mutex
+  if (pthread_mutex_unlock(&fcd_metrics_mutex)) severe_error_0("pthread_mutex_unlock(fcd_metrics_mutex)", errno);
+  return total;
+}
+
+static void fcd_metrics_put(struct FCD_JSON *_out, const char *_str) {
+  fcd_json_put(_out, _str, strlen(_str));
+}
+
+static void fcd_metrics_header(struct FCD_JSON *_out, const struct FCD_METRICS_INFO *_info) {
+  if (!_info->help) return;
+  fcd_json_literal(_out, "# HELP ");
+  fcd_metrics_put(_out, _info->name);
+  fcd_json_literal(_out, " ");
+  fcd_metrics_put(_out, _info->help);
+  fcd_json_literal(_out, "\n# TYPE ");
+  fcd_metrics_put(_out, _info->name);
+  fcd_json_literal(_out, " ");
+  fcd_metrics_put(_out, _info->type);
+  fcd_json_literal(_out, "\n");
+}
+
+//  name{labels} value
+static void fcd_metrics_line(struct FCD_JSON *_out, const char *_name, const char *_suffix, const char *_labels,
+                             const char *_value) {
+  fcd_metrics_put(_out, _name);
+  fcd_metrics_put(_out, _suffix);
+  if (_labels) {
+    fcd_json_literal(_out, "{");
+    fcd_metrics_put(_out, _labels);
+    fcd_json_literal(_out, "}");
+  }
+  fcd_json_literal(_out, " ");
+  fcd_metrics_put(_out, _value);
+  fcd_json_literal(_out, "\n");
+}
+
+/*
+ * void fcd_metrics_text( struct FCD_JSON *out );
+ *
+ * The function fcd_metrics_text() appends all metrics (the shards of all
+ * threads summed up) to out in the Prometheus text exposition format.
+ */
+void fcd_metrics_text(struct FCD_JSON *_out) {
+  uint64_t counters[FCD_METRICS_COUNTERS] = {0};
+  uint64_t buckets[FCD_METRICS_HISTOGRAMS][FCD_METRICS_BUCKETS + 1] = {{0}};
+  uint64_t sums[FCD_METRICS_HISTOGRAMS] = {0};
+  char value[64], labels[64];
+  //  lock mutex
+  if (pthread_mutex_lock(&fcd_metrics_mutex)) severe_error_0("pthread_mutex_lock(fcd_metrics_mutex)", errno);
+  for (struct FCD_METRICS_SHARD *shard = fcd_metrics_shards; shard; shard = shard->next) {
+    for (int i = 0; i < FCD_METRICS_COUNTERS; ++i) counters[i] += __atomic_load_n(&shard->counters[i], __ATOMIC_RELAXED);
+    for (int h = 0; h < FCD_METRICS_HISTOGRAMS; ++h) {
+      for (int b = 0; b <= FCD_METRICS_BUCKETS; ++b)
+        buckets[h][b] += __atomic_load_n(&shard->buckets[h][b], __ATOMIC_RELAXED);
+      sums[h] += __atomic_load_n(&shard->sums[h], __ATOMIC_RELAXED);
+    }
+  }
+  //  unlock mutex
+  if (pthread_mutex_unlock(&fcd_metrics_mutex)) severe_error_0("pthread_mutex_unlock(fcd_metrics_mutex)", errno);
+  for (int i = 0; i < FCD_METRICS_COUNTERS; ++i) {
+    fcd_metrics_header(_out, &fcd_metrics_counters[i]);
+    if (fcd_metrics_counters_ns[i]) snprintf(value, sizeof(value), "%.9f", counters[i] / 1e9);
+    else snprintf(value, sizeof(value), "%llu", (unsigned long long)counters[i]);
+    fcd_metrics_line(_out, fcd_metrics_counters[i].name, "", fcd_metrics_counters[i].labels, value);
+  }
+  for (int h = 0; h < FCD_METRICS_HISTOGRAMS; ++h) {
+    uint64_t count = 0;
+    int64_t le = 1000000;
+    fcd_metrics_header(_out, &fcd_metrics_histograms[h]);
+    //  cumulative buckets
+    for (int b = 0; b <= FCD_METRICS_BUCKETS; ++b, le *= 4) {
+      count += buckets[h][b];
+      if (b < FCD_METRICS_BUCKETS) snprintf(labels, sizeof(labels), "le=\"%g\"", le / 1e9);
+      else snprintf(labels, sizeof(labels), "le=\"+Inf\"");
+      snprintf(value, sizeof(value), "%llu", (unsigned long long)count);
+      fcd_metrics_line(_out, fcd_metrics_histograms[h].name, "_bucket", labels, value);
+    }
+    snprintf(value, sizeof(value), "%.9f", sums[h] / 1e9);
+    fcd_metrics_line(_out, fcd_metrics_histograms[h].name, "_sum", NULL, value);
+    snprintf(value, sizeof(value), "%llu", (unsigned long long)count);
+    fcd_metrics_line(_out, fcd_metrics_histograms[h].name, "_count", NULL, value);
+  }
+  for (int i = 0; i < FCD_METRICS_GAUGES; ++i) {
+    fcd_metrics_header(_out, &fcd_metrics_gauges[i]);
+    snprintf(value, sizeof(value), "%lld", (long long)__atomic_load_n(&fcd_metrics_values[i], __ATOMIC_RELAXED));
+    fcd_metrics_line(_out, fcd_metrics_gauges[i].name, "", fcd_metrics_gauges[i].labels, value);
+  }
+}
@@ -0,0 +1,72 @@
+/*
+ *  File Check Daemon - метрики работы
+ *
+ *  - счётчики и гистограммы ведутся по потокам: у каждого потока свой сегмент
+ *    (shard), поток пишет в него без блокировок и атомарных RMW операций
+ *  - сегмент создаётся при первой записи потока и живёт до конца работы,
+ *    список сегментов - под мьютексом, только при создании и при чтении
+ *  - fcd_metrics_text() складывает сегменты и пишет текст в формате Prometheus
+ *  - гистограммы - длительности в нс, границы корзин 1 мс * 4^k, k = 0..8
+ *  - датчики (gauge) - общие значения, их выставляет один поток
+ */
+#ifndef FICHEDA_METRICS_H
+#define FICHEDA_METRICS_H
+
+#include <stdint.h>
+#include "json.h"
+
+#define FCD_METRICS_BUCKETS   9
+
+enum FCD_METRICS_COUNTER {
+  FCD_METRICS_SCANS_FULL,
+  FCD_METRICS_SCANS_TARGETED,
+  FCD_METRICS_SCANS_DEEP,
+  FCD_METRICS_FILES_CONTENT,
+  FCD_METRICS_FILES_METADATA,
+  FCD_METRICS_FILES_ERROR,
+  FCD_METRICS_FILES_APPENDED,
+  FCD_METRICS_PARTS,
+  FCD_METRICS_BYTES,
+  FCD_METRICS_POOL_WAIT_NS,
+  FCD_METRICS_IO_WAIT_NS,
+  FCD_METRICS_CPU_WAIT_NS,
+  FCD_METRICS_REPORT_WAIT_NS,
+  FCD_METRICS_REPORTS,
+  FCD_METRICS_REPORTS_FULL,
+  FCD_METRICS_CHANGES,
+  FCD_METRICS_COUNTERS
+};
+
+enum FCD_METRICS_HISTOGRAM {
+  FCD_METRICS_SCAN_NS,
+  FCD_METRICS_FILE_NS,
+  FCD_METRICS_REPORT_NS,
+  FCD_METRICS_HISTOGRAMS
+};
+
+enum FCD_METRICS_GAUGE {
+  FCD_METRICS_ETALON_FILES,
+  FCD_METRICS_STATUS_OK,
+  FCD_METRICS_STATUS_FAIL,
+  FCD_METRICS_STATUS_ERROR,
+  FCD_METRICS_STATUS_DELETED,
+  FCD_METRICS_STATUS_NEW,
+  FCD_METRICS_POOL_QUEUE,
+  FCD_METRICS_POOL_PENDING,
+  FCD_METRICS_POOL_THREADS,
+  FCD_METRICS_CONCURRENCY,
+  FCD_METRICS_REPORTS_PENDING,
+  FCD_METRICS_LAST_SCAN_TIME,
+  FCD_METRICS_ROLLING_COVERED,
+  FCD_METRICS_ROLLING_TOTAL,
+  FCD_METRICS_VERIFIED_OLDEST,
+  FCD_METRICS_GAUGES
+};
+
+void fcd_metrics_add(enum FCD_METRICS_COUNTER _counter, uint64_t _value);
+void fcd_metrics_observe(enum FCD_METRICS_HISTOGRAM _histogram, int64_t _ns);
+void fcd_metrics_set(enum FCD_METRICS_GAUGE _gauge, int64_t _value);
+uint64_t fcd_metrics_total(enum FCD_METRICS_COUNTER _counter);
+void fcd_metrics_text(struct FCD_JSON *_out);
+
+#endif //FICHEDA_METRICS_H
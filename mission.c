@@ -0,0 +1,1630 @@
+/*
+ *  File Check Daemon - миссия: сканирование каталога, расчёт, отчёты
+ *
+ *  Calculators-Launcher, задания пула Tree-Walker и Calculator, потоки inotify,
+ *  JSON-writer и Metrics-writer (общий алгоритм - в main.c). Имена файлов -
+ *  относительно path миссии, открываются через её dirfd. Задание пула находит
+ *  свою миссию через группу: _worker->group->owner.
+ */
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "budget.h"
+#include "control.h"
+#include "crc32.h"
+#include "device.h"
+#include "digest.h"
+#include "etadb.h"
+#include "etalon.h"
+#include "ficheda.h"
+#include "json.h"
+#include "metrics.h"
+#include "mission.h"
+#include "pool.h"
+#include "reader.h"
+#include "results.h"
+#include "rolling.h"
+#include "tree.h"
+
+#define INO_EVENT_SIZE     sizeof(struct inotify_event)
+#define INO_BUFF_SIZE      65536
+#define INO_WATCH_MASK     (IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)
+
+int mission_threads = 0;
+long mission_io_rate = 0;
+int mission_cpu = 0;
+enum FCD_READ_MODE mission_read = FCD_READ_BUFFERED;
+int mission_depth = FCD_URING_DEPTH;
+long mission_split = SPLIT_SIZE;
+long mission_chunk = SPLIT_CHUNK;
+const char *mission_verify_names[] = {"full", "early", "append", NULL};
+char* mission_metrics = NULL;
+
+struct FCD_MISSION *fcd_missions = NULL;
+sem_t sem_metrics;
+pthread_t tid_inotify;
+struct FCD_POOL *crc32_pool = NULL;
+struct FCD_BUDGET io_budget;
+struct FCD_BUDGET cpu_budget;
+
+void thread_crc32_calculator_entry_point(struct FCD_WORKER *_worker, void *_arg);
+void thread_crc32_calculator_elevator(struct FCD_WORKER *_worker, void *_arg);
+void thread_tree_walker_entry_point(struct FCD_WORKER *_worker, void *_arg);
+
+//  the level to start with: from the device of the mission directory, or the fixed concurrency
+static void fcd_mission_level(struct FCD_MISSION *_mission) {
+  fcd_device_probe(&_mission->device, _mission->path);
+  if (_mission->concurrency) _mission->level = _mission->level_max = _mission->concurrency;
+  else fcd_device_concurrency(&_mission->device, &_mission->level, &_mission->level_max);
+  _mission->level_step = 1;
+}
+
+/*
+ * void fcd_mission_init( void );
+ *
+ * The function fcd_mission_init() prepares what the missions share: read
+ * engines, budgets and the calculator pool. The missions known by now size
+ * the pool (threads=0): the sum of the most jobs at once of their devices.
+ */
+void fcd_mission_init(void) {
+  //  initialize I/O & CPU budgets
+  fcd_budget_init(&io_budget, mission_io_rate);
+  fcd_budget_init(&cpu_budget, mission_cpu * 1e7 * sysconf(_SC_NPROCESSORS_ONLN));
+  //  select CRC-32 kernel
+  crc32_init();
+  syslog(LOG_NOTICE, "crc32_kernel     = [%s]\n", crc32_kernel_name());
+  syslog(LOG_NOTICE, "digest_kernel    = [%s]\n", fcd_digest->kernel());
+  //  SIGBUS guard for the mmap read mode
+  fcd_read_init(mission_depth);
+  if (mission_read == FCD_READ_URING && !fcd_read_uring_probe()) {
+    syslog(LOG_WARNING, "io_uring is not available, read mode [%s]", fcd_read_mode_names[FCD_READ_BUFFERED]);
+    mission_read = FCD_READ_BUFFERED;
+  }
+  if (sem_init(&sem_metrics, 0, 0)) severe_error_0("sem_init(sem_metrics)", errno);
+  if (!mission_threads) {
+    for (struct FCD_MISSION *mission = fcd_missions; mission; mission = mission->next) {
+      fcd_mission_level(mission);
+      mission_threads += mission->level_max;
+    }
+    if (mission_threads < 1) mission_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (mission_threads < 1) mission_threads = 1;
+    if (mission_threads > CRC_THREADS_MAX) mission_threads = CRC_THREADS_MAX;
+  }
+  syslog(LOG_NOTICE, "pool_threads     = [%i]\n", mission_threads);
+  crc32_pool = fcd_pool_create(mission_threads, FIN_BUFF_SIZE);
+}
+
+/*
+ * struct FCD_MISSION *fcd_mission_new( void );
+ *
+ * The function fcd_mission_new() returns a new mission with the default
+ * parameters, appended to the list fcd_missions.
+ */
+struct FCD_MISSION *fcd_mission_new(void) {
+  struct FCD_MISSION *mission = my_malloc(sizeof(struct FCD_MISSION)), **last = &fcd_missions;
+  memset(mission, 0, sizeof(struct FCD_MISSION));
+  mission->deep = DEEP_INTERVAL;
+  mission->debounce = SCAN_DEBOUNCE;
+  mission->gap = SCAN_GAP;
+  mission->reports = FCD_RESULTS_REPORTS;
+  mission->rotate = CHANGES_ROTATE;
+  mission->full = 1;
+  mission->verify = FCD_VERIFY_FULL;
+  mission->order = FCD_ORDER_AUTO;
+  mission->scan_deep = 1;
+  mission->dirfd = -1;
+  mission->inotify_fd = -1;
+  mission->inotify_root_wd = -1;
+  while (*last) last = &(*last)->next;
+  *last = mission;
+  return mission;
+}
+
+/*
+ * void fcd_mission_start( struct FCD_MISSION *mission );
+ *
+ * The function fcd_mission_start() opens the mission directory and prepares
+ * the mission state for scans: semaphores, the report queue and the group of
+ * the mission in the calculator pool. Call fcd_mission_init() first.
+ */
+void fcd_mission_start(struct FCD_MISSION *_mission) {
+  //  connect to mission directory
+  syslog(LOG_NOTICE, "Connect to mission_path: %s", _mission->path);
+  _mission->dirfd = open(_mission->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (_mission->dirfd < 0) {
+    syslog(LOG_ERR, "open(mission_path): %s: %s", _mission->path, strerror(errno));
+    syslog(LOG_NOTICE, "Program stoped (UserID=%i & PID=%i)", getuid(), getpid());
+    exit(EXIT_FAILURE);
+  }
+  //  initialize some semaphore & mutex
+  if (sem_init(&_mission->sem_queue, 0, 0)) severe_error_0("sem_init(sem_queue)", errno);
+  if (pthread_mutex_init(&_mission->mutex_touched, NULL)) severe_error_0("pthread_mutex_init(mutex_touched)", errno);
+  if (pthread_cond_init(&_mission->cond_touched, NULL)) severe_error_0("pthread_cond_init(cond_touched)", errno);
+  if (pthread_mutex_init(&_mission->mutex_etalon, NULL)) severe_error_0("pthread_mutex_init(mutex_etalon)", errno);
+  //  create results queue for JSON-writer
+  fcd_results_init(&_mission->results, _mission->reports);
+  //  the share of the pool - the jobs of the mission at once, no more than the pool runs
+  if (!_mission->level) fcd_mission_level(_mission);
+  if (_mission->level_max > mission_threads) _mission->level_max = mission_threads;
+  if (_mission->level > _mission->level_max) _mission->level = _mission->level_max;
+  //  the elevator order pays where a seek costs more than a read
+  _mission->order_mode = _mission->order;
+  if (_mission->order_mode == FCD_ORDER_AUTO)
+    _mission->order_mode = _mission->device.kind == FCD_DEVICE_HDD ? FCD_ORDER_EXTENT : FCD_ORDER_READDIR;
+  syslog(LOG_NOTICE, "Device of %s: %s [%s], queue depth %i, concurrency %i%s, order %s", _mission->path,
+         _mission->device.name[0] ? _mission->device.name : "-", fcd_device_kind_names[_mission->device.kind],
+         _mission->device.queue_depth, _mission->level, _mission->concurrency ? " (fixed)" : "",
+         fcd_order_names[_mission->order_mode]);
+  fcd_pool_group_init(&_mission->group, _mission->level, _mission);
+  //  the records keep the time of verification from the first file on
+  if (_mission->rolling || _mission->cycle) {
+    _mission->etalon.verified = 1;
+    if (_mission->cycle)
+      syslog(LOG_NOTICE, "Rolling verification of %s: %li bytes per scan, whole list in %i scans at most",
+             _mission->path, _mission->rolling, _mission->cycle);
+    else
+      syslog(LOG_NOTICE, "Rolling verification of %s: %li bytes per scan", _mission->path, _mission->rolling);
+    if (!_mission->etalon_file)
+      syslog(LOG_WARNING, "Rolling verification of %s: no etalon file, the cursor is not kept across restarts",
+             _mission->path);
+  }
+}
+
+static void fcd_touched_push_locked(struct FCD_MISSION *_mission, const char *_name) {
+  if (_mission->touched_count == _mission->touched_capacity) {
+    _mission->touched_capacity = _mission->touched_capacity ? _mission->touched_capacity * 2 : 64;
+    char **names = my_malloc(sizeof(char *) * _mission->touched_capacity);
+    if (_mission->touched_count) memcpy(names, _mission->touched_names, sizeof(char *) * _mission->touched_count);
+    free(_mission->touched_names);
+    _mission->touched_names = names;
+  }
+  _mission->touched_names[_mission->touched_count++] = my_strdup((char *)_name);
+}
+
+void fcd_touched_push(struct FCD_MISSION *_mission, const char *_name) {
+  //  lock mutex
+  if (pthread_mutex_lock(&_mission->mutex_touched)) severe_error_0("pthread_mutex_lock(mutex_touched)", errno);
+  fcd_touched_push_locked(_mission, _name);
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_mission->mutex_touched)) severe_error_0("pthread_mutex_unlock(mutex_touched)", errno);
+}
+
+char **fcd_touched_take(struct FCD_MISSION *_mission, size_t *_count) {
+  //  lock mutex
+  if (pthread_mutex_lock(&_mission->mutex_touched)) severe_error_0("pthread_mutex_lock(mutex_touched)", errno);
+  char **names = _mission->touched_names;
+  *_count = _mission->touched_count;
+  _mission->touched_names = NULL;
+  _mission->touched_count = _mission->touched_capacity = 0;
+  //  the requests up to here go to this scan, the named files of a request are re-hashed
+  _mission->touched_taken = _mission->touched_ticket;
+  _mission->scan_verify = _mission->touched_verify;
+  _mission->touched_verify = 0;
+  __atomic_store_n(&_mission->touched_urgent, 0, __ATOMIC_RELAXED);
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_mission->mutex_touched)) severe_error_0("pthread_mutex_unlock(mutex_touched)", errno);
+  return names;
+}
+
+void fcd_touched_free(char **_names, size_t _count) {
+  for (size_t n = 0; n < _count; ++n) free(_names[n]);
+  free(_names);
+}
+
+/*
+ * uint64_t fcd_touched_request( struct FCD_MISSION *mission, char **names, size_t count, int full );
+ *
+ * The function fcd_touched_request() asks the launcher for a scan now (no
+ * debounce and gap): the named files are re-hashed even with the stat()
+ * signature unchanged, full - the whole tree. Returns the ticket for
+ * fcd_touched_wait().
+ */
+uint64_t fcd_touched_request(struct FCD_MISSION *_mission, char **_names, size_t _count, int _full) {
+  uint64_t ticket;
+  //  lock mutex
+  if (pthread_mutex_lock(&_mission->mutex_touched)) severe_error_0("pthread_mutex_lock(mutex_touched)", errno);
+  for (size_t n = 0; n < _count; ++n) fcd_touched_push_locked(_mission, _names[n]);
+  if (_count) _mission->touched_verify = 1;
+  if (_full) __atomic_store_n(&_mission->scan_full_pending, 1, __ATOMIC_RELEASE);
+  __atomic_store_n(&_mission->touched_urgent, 1, __ATOMIC_RELAXED);
+  ticket = ++_mission->touched_ticket;
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_mission->mutex_touched)) severe_error_0("pthread_mutex_unlock(mutex_touched)", errno);
+  if (sem_post(&_mission->sem_queue)) severe_error_0("sem_post(sem_queue)", errno);
+  return ticket;
+}
+
+//  waits for the report of the scan that took the request
+void fcd_touched_wait(struct FCD_MISSION *_mission, uint64_t _ticket) {
+  //  lock mutex
+  if (pthread_mutex_lock(&_mission->mutex_touched)) severe_error_0("pthread_mutex_lock(mutex_touched)", errno);
+  while (_mission->touched_done < _ticket)
+    if (pthread_cond_wait(&_mission->cond_touched, &_mission->mutex_touched))
+      severe_error_0("pthread_cond_wait(cond_touched)", errno);
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_mission->mutex_touched)) severe_error_0("pthread_mutex_unlock(mutex_touched)", errno);
+}
+
+//  the launcher: the names taken last are scanned and reported (or nothing was due)
+void fcd_touched_done(struct FCD_MISSION *_mission) {
+  //  lock mutex
+  if (pthread_mutex_lock(&_mission->mutex_touched)) severe_error_0("pthread_mutex_lock(mutex_touched)", errno);
+  if (_mission->touched_done != _mission->touched_taken) {
+    _mission->touched_done = _mission->touched_taken;
+    if (pthread_cond_broadcast(&_mission->cond_touched)) severe_error_0("pthread_cond_broadcast(cond_touched)", errno);
+  }
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_mission->mutex_touched)) severe_error_0("pthread_mutex_unlock(mutex_touched)", errno);
+}
+
+//  events of one mission from its inotify instance
+void thread_mission_path_inotify_read(struct FCD_MISSION *_mission, char *_ino_buff, size_t _size) {
+  int rl, wakeup;
+  char name[PATH_MAX];
+  struct inotify_event *ino_event;
+  //  read inotify event structures
+  rl = read(_mission->inotify_fd, _ino_buff, _size);
+  if (rl < 1) severe_error_0("read(INOTIFY)", errno);
+  //  check every event in the buffer
+  wakeup = 0;
+  for (char *ptr = _ino_buff; ptr < _ino_buff + rl; ptr += INO_EVENT_SIZE + ino_event->len) {
+    ino_event = (struct inotify_event *)ptr;
+    if (ino_event->mask & IN_IGNORED) {
+      //  the watched directory is gone
+      fcd_watches_drop(&_mission->watches, ino_event->wd);
+      continue;
+    }
+    if ((ino_event->mask & IN_DELETE_SELF) || (ino_event->mask & IN_MOVE_SELF)) {
+      //  a subdirectory - its parent reports it
+      if (ino_event->wd != _mission->inotify_root_wd) continue;
+      //  disaster!!!
+      syslog(LOG_ERR, "Disaster!!! Mission directory - deleted!!! (%s)", _mission->path);
+      exit(EXIT_FAILURE);
+    }
+    if (ino_event->mask & IN_Q_OVERFLOW) {
+      //  events lost - full rescan
+      __atomic_store_n(&_mission->scan_full_pending, 1, __ATOMIC_RELEASE);
+      wakeup = 1;
+      continue;
+    }
+    if (!ino_event->len) continue;
+    //  directories matter for the recursive mode only, IN_CREATE - for directories only
+    if ((ino_event->mask & IN_ISDIR) ? !_mission->recursive : (ino_event->mask & IN_CREATE) != 0) continue;
+    //  remember the name relative to the mission directory for targeted rescan
+    if (!fcd_watches_name(&_mission->watches, ino_event->wd, ino_event->name, name, sizeof(name))) continue;
+    fcd_touched_push(_mission, name);
+    wakeup = 1;
+  }
+  //  post the semaphore of the mission
+  if (wakeup) sem_post(&_mission->sem_queue);
+}
+
+//  one thread for the inotify instances of all missions
+_Noreturn void *thread_mission_path_inotify(void *_arg){
+  static char ino_buff[INO_BUFF_SIZE] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  struct FCD_MISSION *mission;
+  int count = 0, n;
+  for (mission = fcd_missions; mission; mission = mission->next) ++count;
+  struct pollfd fds[count];
+  for (mission = fcd_missions, n = 0; mission; mission = mission->next, ++n) {
+    fds[n].fd = mission->inotify_fd;
+    fds[n].events = POLLIN;
+  }
+  //  loop for inotify
+  while (1) {
+    if (poll(fds, count, -1) < 0) {
+      if (errno == EINTR) continue;
+      severe_error_0("poll(INOTIFY)", errno);
+    }
+    for (mission = fcd_missions, n = 0; mission; mission = mission->next, ++n)
+      if (fds[n].revents) thread_mission_path_inotify_read(mission, ino_buff, sizeof(ino_buff));
+  }
+}
+
+uint32_t thread_calculators_launcher_inotify_mask(struct FCD_MISSION *_mission) {
+  //  IN_CREATE - a new subdirectory is walked at once
+  return _mission->recursive ? INO_WATCH_MASK | IN_CREATE : INO_WATCH_MASK;
+}
+
+//  watches are added before the initial calculation, the walk adds subdirectories
+void thread_calculators_launcher_inotify_init(struct FCD_MISSION *_mission) {
+  //  initialize inotify
+  _mission->inotify_fd = inotify_init1(IN_CLOEXEC);   // Create inotify instance
+  if (_mission->inotify_fd == -1) severe_error_0("inotify_init()", errno);
+  fcd_watches_init(&_mission->watches, _mission->path);
+  //  add watch
+  _mission->inotify_root_wd = fcd_watches_add(&_mission->watches, _mission->inotify_fd, "",
+                                              thread_calculators_launcher_inotify_mask(_mission));
+  if (_mission->inotify_root_wd == -1) severe_error_0("inotify_add_watch()", errno);
+}
+
+//  after thread_calculators_launcher_inotify_init() of every mission
+void thread_calculators_launcher_inotify(void) {
+  int cc;
+  //  create thread
+  cc = pthread_create(&tid_inotify, NULL, &thread_mission_path_inotify, NULL);
+  if (cc != 0) severe_error_0("pthread_create(fcd_file)", cc);
+}
+
+void thread_calculators_launcher_queue(struct FCD_MISSION *_mission, struct FCD_FILE *_fcd_file) {
+  _mission->batch[_mission->batch_len++] = _fcd_file;
+  if (_mission->batch_len == CRC_BATCH_SIZE) {
+    fcd_pool_submit_batch(crc32_pool, &_mission->group, &thread_crc32_calculator_entry_point, _mission->batch,
+                          _mission->batch_len);
+    _mission->batch_len = 0;
+  }
+}
+
+//  waits for the jobs of this mission only, the other missions share the pool meanwhile
+void thread_calculators_launcher_flush(struct FCD_MISSION *_mission) {
+  fcd_pool_submit_batch(crc32_pool, &_mission->group, &thread_crc32_calculator_entry_point, _mission->batch,
+                        _mission->batch_len);
+  _mission->batch_len = 0;
+  int64_t wait_ns = fcd_clock_ns(CLOCK_MONOTONIC);
+  fcd_pool_wait(&_mission->group);
+  fcd_metrics_add(FCD_METRICS_POOL_WAIT_NS, fcd_clock_ns(CLOCK_MONOTONIC) - wait_ns);
+}
+
+//  regular file is present in the mission directory (mutex_etalon is locked)
+//  returns the file to calculate or NULL
+struct FCD_FILE *thread_calculators_launcher_found_locked(struct FCD_MISSION *_mission, const char *_name) {
+  struct FCD_FILE *fcd_file = fcd_etalon_find(&_mission->etalon, _name);
+  if (!fcd_file) {
+    fcd_file = fcd_etalon_append(&_mission->etalon, _name);
+    //  the initial calculation builds the list
+    if (!_mission->scan_initial) fcd_file->state = FCD_STATE_ADD;
+  }
+  if (!fcd_etalon_seen_mark(&_mission->etalon, fcd_file)) return NULL;
+  switch (fcd_file->state) {
+    case FCD_STATE_ADD:
+    case FCD_STATE_GONE:
+      //  the file not exists in original list
+      fcd_file->state = FCD_STATE_ADD;
+      syslog(LOG_WARNING, "Integrity check: FAIL (%s/%s - NEW)", _mission->path, fcd_file->name);
+      return NULL;
+    default:
+      return fcd_file;
+  }
+}
+
+void thread_calculators_launcher_found(struct FCD_MISSION *_mission, const char *_name) {
+  //  lock mutex
+  if (pthread_mutex_lock(&_mission->mutex_etalon)) severe_error_0("pthread_mutex_lock(mutex_etalon)", errno);
+  struct FCD_FILE *fcd_file = thread_calculators_launcher_found_locked(_mission, _name);
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_mission->mutex_etalon)) severe_error_0("pthread_mutex_unlock(mutex_etalon)", errno);
+  if (fcd_file) thread_calculators_launcher_queue(_mission, fcd_file);
+}
+
+//  file is missing from the mission directory
+void thread_calculators_launcher_lost(struct FCD_MISSION *_mission, struct FCD_FILE *_fcd_file) {
+  switch (_fcd_file->state) {
+    case FCD_STATE_ADD:
+    case FCD_STATE_GONE:
+      _fcd_file->state = FCD_STATE_GONE;
+      break;
+    default:
+      _fcd_file->state = FCD_STATE_DEL;
+      syslog(LOG_WARNING, "Integrity check: FAIL (%s/%s - DELETED)", _mission->path, _fcd_file->name);
+      break;
+  }
+}
+
+//  the directory is gone - so is every file below it (mutex_etalon is locked)
+void thread_calculators_launcher_lost_tree(struct FCD_MISSION *_mission, const char *_path) {
+  size_t len = strlen(_path);
+  struct FCD_FILE *fcd_file;
+  for (size_t n = 0; n < _mission->etalon.count; ++n) {
+    fcd_file = fcd_etalon_file(&_mission->etalon, n);
+    if (strncmp(fcd_file->name, _path, len) || fcd_file->name[len] != '/') continue;
+    if (fcd_etalon_seen_mark(&_mission->etalon, fcd_file)) thread_calculators_launcher_lost(_mission, fcd_file);
+  }
+}
+
+//  directory of the mission tree, the path is relative ("" - the mission directory)
+struct FCD_WALK {
+    struct FCD_WALK *next;
+    size_t path_len;
+    char path[];
+};
+
+struct FCD_WALK_CTX {
+    struct FCD_MISSION *mission;
+    struct FCD_WORKER *worker;
+    struct FCD_WALK *walk;
+    struct FCD_WALK *subdirs;
+    char *name;
+};
+
+struct FCD_WALK *thread_tree_walker_new(const char *_path, size_t _len) {
+  struct FCD_WALK *walk = my_malloc(sizeof(struct FCD_WALK) + _len + 1);
+  walk->next = NULL;
+  walk->path_len = _len;
+  memcpy(walk->path, _path, _len);
+  walk->path[_len] = '\0';
+  return walk;
+}
+
+//  one entry of the directory from getdents64()
+void thread_tree_walker_entry(void *_ctx, const char *_name, unsigned char _type, uint64_t _ino) {
+  struct FCD_WALK_CTX *ctx = _ctx;
+  struct FCD_MISSION *mission = ctx->mission;
+  struct FCD_WALK *walk = ctx->walk;
+  struct FCD_FILE *fcd_file;
+  size_t len = strlen(_name);
+  //  relative name = directory path + "/" + entry name
+  char *name = ctx->name;
+  if (walk->path_len) {
+    memcpy(name, walk->path, walk->path_len);
+    name[walk->path_len] = '/';
+    name += walk->path_len + 1;
+  }
+  memcpy(name, _name, len + 1);
+  switch (_type) {
+    case DT_REG:
+      //  lock mutex
+      if (pthread_mutex_lock(&mission->mutex_etalon)) severe_error_0("pthread_mutex_lock(mutex_etalon)", errno);
+      fcd_file = thread_calculators_launcher_found_locked(mission, ctx->name);
+      //  the elevator order - the file waits for the end of the walk
+      if (fcd_file && mission->scan_ordered) {
+        fcd_elevator_push(&mission->elevator, _ino, fcd_file);
+        fcd_file = NULL;
+      }
+      //  unlock mutex
+      if (pthread_mutex_unlock(&mission->mutex_etalon)) severe_error_0("pthread_mutex_unlock(mutex_etalon)", errno);
+      //  the queue is full or the mission used its share - calculate here (the worker buffer is free,
+      //  getdents64 has its own)
+      if (fcd_file && !fcd_pool_try_submit(crc32_pool, &mission->group, &thread_crc32_calculator_entry_point, fcd_file))
+        thread_crc32_calculator_entry_point(ctx->worker, fcd_file);
+      break;
+    case DT_DIR:
+      if (!mission->recursive) break;
+      //  walked after this directory is closed
+      walk = thread_tree_walker_new(ctx->name, (name - ctx->name) + len);
+      walk->next = ctx->subdirs;
+      ctx->subdirs = walk;
+      break;
+    default:
+      break;
+  }
+}
+
+//  returns the subdirectories to walk
+struct FCD_WALK *thread_tree_walker_dir(struct FCD_WORKER *_worker, struct FCD_WALK *_walk) {
+  static int watches_warned = 0;
+  struct FCD_MISSION *mission = _worker->group->owner;
+  char name[_walk->path_len + NAME_MAX + 2];
+  struct FCD_WALK_CTX ctx = {mission, _worker, _walk, NULL, name};
+  int fd = fcd_tree_open(mission->dirfd, _walk->path);
+  if (fd < 0) {
+    if (!_walk->path_len) severe_error_0("opendir(mission_path)", errno);
+    //  removed during the walk or no access - the files below are not seen
+    syslog(LOG_WARNING, "Tree walk: %s/%s - open: %s", mission->path, _walk->path, strerror(errno));
+    return NULL;
+  }
+  if (mission->recursive && _walk->path_len && mission->inotify_fd >= 0) {
+    if (fcd_watches_add(&mission->watches, mission->inotify_fd, _walk->path,
+                        thread_calculators_launcher_inotify_mask(mission)) < 0 &&
+        !__atomic_exchange_n(&watches_warned, 1, __ATOMIC_RELAXED)) {
+      //  fs.inotify.max_user_watches - changes are caught by the interval scans only
+      syslog(LOG_WARNING, "inotify_add_watch(%s/%s): %s", mission->path, _walk->path, strerror(errno));
+    }
+  }
+  int cc = fcd_tree_read(fd, &thread_tree_walker_entry, &ctx);
+  if (cc) {
+    if (!_walk->path_len) severe_error_0("getdents64(mission_path)", cc);
+    syslog(LOG_WARNING, "Tree walk: %s/%s - getdents64: %s", mission->path, _walk->path, strerror(cc));
+  }
+  close(fd);
+  return ctx.subdirs;
+}
+
+void thread_tree_walker_entry_point(struct FCD_WORKER *_worker, void *_arg) {
+  struct FCD_WALK *walk = _arg, *subdirs, *subdir;
+  while (walk) {
+    struct FCD_WALK *next = walk->next;
+    subdirs = thread_tree_walker_dir(_worker, walk);
+    free(walk);
+    walk = next;
+    //  subdirectories go to other threads, what does not fit in the queue is walked here
+    while ((subdir = subdirs)) {
+      subdirs = subdir->next;
+      subdir->next = NULL;
+      if (!fcd_pool_try_submit(crc32_pool, _worker->group, &thread_tree_walker_entry_point, subdir)) {
+        subdir->next = walk;
+        walk = subdir;
+      }
+    }
+  }
+}
+
+//  the bytes [from, to) of the file to read in the slice of this scan (rolling), 0 - not in the slice
+int thread_calculators_launcher_sampled(struct FCD_MISSION *_mission, struct FCD_FILE *_fcd_file, uint64_t *_from,
+                                        uint64_t *_to) {
+  return _mission->scan_rolling && _fcd_file->state == FCD_STATE_OLD &&
+         fcd_rolling_range(&_mission->cover, _fcd_file->index, _fcd_file->sig.size, _from, _to);
+}
+
+//  the files of the walk in the order of their place on the disk: inode numbers, or the first extents
+//  of the files to read (FIEMAP) - the files not to read (stat() only) go first; level jobs read them
+void thread_calculators_launcher_elevator(struct FCD_MISSION *_mission) {
+  struct stat st;
+  uint64_t from, to;
+  void *jobs[_mission->level];
+  struct FCD_ELEVATOR *elevator = &_mission->elevator;
+  if (_mission->order_mode == FCD_ORDER_EXTENT) {
+    for (size_t n = 0; n < elevator->count; ++n) {
+      struct FCD_ELEVATOR_ITEM *item = &elevator->items[n];
+      struct FCD_FILE *fcd_file = item->file;
+      if (!_mission->scan_deep && fcd_file->state == FCD_STATE_OLD &&
+          !thread_calculators_launcher_sampled(_mission, fcd_file, &from, &to) &&
+          fstatat(_mission->dirfd, fcd_file->name, &st, 0) == 0 && fcd_stat_equal(&fcd_file->sig, &st)) {
+        item->key = 0;
+        continue;
+      }
+      int cc = fcd_elevator_extent(_mission->dirfd, fcd_file->name, &item->key);
+      if (cc == EOPNOTSUPP || cc == ENOTTY) {
+        syslog(LOG_WARNING, "FIEMAP(%s): %s, order %s", _mission->path, strerror(cc), fcd_order_names[FCD_ORDER_INODE]);
+        _mission->order_mode = FCD_ORDER_INODE;
+        for (n = 0; n < elevator->count; ++n) elevator->items[n].key = elevator->items[n].ino;
+        break;
+      }
+    }
+  }
+  fcd_elevator_sort(elevator);
+  elevator->next = 0;
+  for (int i = 0; i < _mission->level; ++i) jobs[i] = NULL;
+  fcd_pool_submit_batch(crc32_pool, &_mission->group, &thread_crc32_calculator_elevator, jobs, _mission->level);
+}
+
+void thread_calculators_launcher_scan_full(struct FCD_MISSION *_mission) {
+  struct FCD_FILE *fcd_file;
+  //  walk the tree (the walk submits the files to calculate, or lists them for the elevator)
+  _mission->scan_ordered = _mission->order_mode != FCD_ORDER_READDIR;
+  fcd_pool_submit(crc32_pool, &_mission->group, &thread_tree_walker_entry_point, thread_tree_walker_new("", 0));
+  if (_mission->scan_ordered) {
+    int64_t wait_ns = fcd_clock_ns(CLOCK_MONOTONIC);
+    fcd_pool_wait(&_mission->group);
+    fcd_metrics_add(FCD_METRICS_POOL_WAIT_NS, fcd_clock_ns(CLOCK_MONOTONIC) - wait_ns);
+    _mission->scan_ordered = 0;
+    thread_calculators_launcher_elevator(_mission);
+  }
+  //  wait for all jobs end
+  thread_calculators_launcher_flush(_mission);
+  _mission->elevator.count = 0;
+  //  check for missing files
+  size_t unseen_pos = 0;
+  //  lock mutex
+  if (pthread_mutex_lock(&_mission->mutex_etalon)) severe_error_0("pthread_mutex_lock(mutex_etalon)", errno);
+  while ((fcd_file = fcd_etalon_next_unseen(&_mission->etalon, &unseen_pos)))
+    thread_calculators_launcher_lost(_mission, fcd_file);
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_mission->mutex_etalon)) severe_error_0("pthread_mutex_unlock(mutex_etalon)", errno);
+}
+
+void thread_calculators_launcher_scan_names(struct FCD_MISSION *_mission, char **_names, size_t _count) {
+  struct stat st;
+  struct FCD_FILE *fcd_file;
+  for (size_t n = 0; n < _count; ++n) {
+    int found = fstatat(_mission->dirfd, _names[n], &st, 0) == 0;
+    if (found && S_ISREG(st.st_mode)) {
+      thread_calculators_launcher_found(_mission, _names[n]);
+    } else if (found && S_ISDIR(st.st_mode) && _mission->recursive) {
+      //  new or moved in directory - walk its subtree
+      fcd_pool_submit(crc32_pool, &_mission->group, &thread_tree_walker_entry_point,
+                      thread_tree_walker_new(_names[n], strlen(_names[n])));
+    } else {
+      //  lock mutex
+      if (pthread_mutex_lock(&_mission->mutex_etalon)) severe_error_0("pthread_mutex_lock(mutex_etalon)", errno);
+      fcd_file = fcd_etalon_find(&_mission->etalon, _names[n]);
+      if (fcd_file && fcd_etalon_seen_mark(&_mission->etalon, fcd_file))
+        thread_calculators_launcher_lost(_mission, fcd_file);
+      if (_mission->recursive) thread_calculators_launcher_lost_tree(_mission, _names[n]);
+      //  unlock mutex
+      if (pthread_mutex_unlock(&_mission->mutex_etalon)) severe_error_0("pthread_mutex_unlock(mutex_etalon)", errno);
+      if (_mission->recursive) fcd_watches_drop_tree(&_mission->watches, _mission->inotify_fd, _names[n]);
+    }
+  }
+  //  wait for all jobs end
+  thread_calculators_launcher_flush(_mission);
+}
+
+//  read throughput of the scan per read mode
+void thread_calculators_launcher_read_stats(int64_t _scan_ns) {
+  struct FCD_READ_STATS stats;
+  for (int mode = 0; mode < FCD_READ_MODES; ++mode) {
+    fcd_read_stats_take(mode, &stats);
+    if (!stats.files) continue;
+    syslog(LOG_INFO, "Read %s: %lu files, %lu bytes, %.1f MB/s per thread, %.1f MB/s per scan",
+           fcd_read_mode_names[mode], (unsigned long)stats.files, (unsigned long)stats.bytes,
+           stats.ns ? stats.bytes * 1e3 / stats.ns : 0.0, _scan_ns > 0 ? stats.bytes * 1e3 / _scan_ns : 0.0);
+  }
+}
+
+//  hill climbing on the read throughput: a scan that read FCD_ADAPT_BYTES at least moves
+//  the level by a step, on in the same direction while the throughput grows by FCD_ADAPT_GAIN,
+//  else back; the group is idle after the scan, so its slots change at once
+void thread_calculators_launcher_adapt(struct FCD_MISSION *_mission, int64_t _scan_ns) {
+  uint64_t bytes = __atomic_exchange_n(&_mission->bytes_read, 0, __ATOMIC_RELAXED);
+  if (_mission->concurrency || _mission->level_max < 2 || bytes < FCD_ADAPT_BYTES || _scan_ns <= 0) return;
+  double rate = bytes * 1e3 / _scan_ns;
+  if (_mission->level_rate > 0 && rate < _mission->level_rate * (1 + FCD_ADAPT_GAIN))
+    _mission->level_step = -_mission->level_step;
+  _mission->level_rate = rate;
+  int step = _mission->level < 8 ? 1 : _mission->level / 4;
+  int level = _mission->level + _mission->level_step * step;
+  if (level < 1 || level > _mission->level_max) {
+    //  at the bound - the other way
+    _mission->level_step = -_mission->level_step;
+    level = _mission->level + _mission->level_step * step;
+    if (level < 1) level = 1;
+    if (level > _mission->level_max) level = _mission->level_max;
+  }
+  syslog(LOG_INFO, "Concurrency %s: %i -> %i (%.1f MB/s per scan)", _mission->path, _mission->level, level, rate);
+  fcd_pool_group_resize(&_mission->group, level);
+  __atomic_store_n(&_mission->level, level, __ATOMIC_RELAXED);
+}
+
+//  merge triggers: debounce window & minimal gap between scans (a control request - at once)
+void thread_calculators_launcher_settle(struct FCD_MISSION *_mission, int64_t _scan_last) {
+  int64_t wait = (int64_t)_mission->debounce * 1000000;
+  int64_t gap = _scan_last + (int64_t)_mission->gap * 1000000 - fcd_clock_ns(CLOCK_MONOTONIC);
+  if (gap > wait) wait = gap;
+  if (__atomic_load_n(&_mission->touched_urgent, __ATOMIC_RELAXED)) wait = 0;
+  if (wait > 0) fcd_sleep_ns(wait);
+  //  all triggers posted meanwhile go to this scan
+  while (sem_trywait(&_mission->sem_queue) == 0);
+}
+
+//  changed blocks of a FAIL file (and blocks skipped by early verification), adjacent ones merged
+void thread_calculators_launcher_ranges(struct FCD_REPORT *_report, struct FCD_FILE *_fcd_file) {
+  struct FCD_BLOCKS *blocks = _fcd_file->blocks;
+  struct FCD_RANGE *range = NULL;
+  if (!blocks || !blocks->original_count || !blocks->next_count) return;
+  size_t count = blocks->original_count > blocks->next_count ? blocks->original_count : blocks->next_count;
+  for (size_t n = 0; n < count; ++n) {
+    const struct FCD_DIGEST_PART *original = n < blocks->original_count ? &blocks->original[n] : NULL;
+    const struct FCD_DIGEST_PART *next = n < blocks->next_count ? &blocks->next[n] : NULL;
+    int unverified = next && next->bytes == FCD_BLOCK_SKIPPED;
+    if (!unverified && original && next && original->bytes == next->bytes &&
+        !memcmp(original->value, next->value, fcd_digest->size))
+      continue;
+    uint64_t start = (uint64_t)n * mission_chunk, bytes;
+    if (!unverified) bytes = next ? next->bytes : original->bytes;
+    else if (_fcd_file->sig.size - start < (uint64_t)mission_chunk) bytes = _fcd_file->sig.size - start;
+    else bytes = mission_chunk;
+    if (range && range->end == start && range->unverified == unverified) {
+      range->end = start + bytes;
+    } else {
+      range = fcd_results_range(_report);
+      range->start = start;
+      range->end = start + bytes;
+      range->unverified = unverified;
+    }
+  }
+}
+
+//  the status of a file of the list, 0 - not reported
+int thread_calculators_launcher_code(struct FCD_FILE *_fcd_file) {
+  switch (_fcd_file->state) {
+    case FCD_STATE_OLD:
+      if (_fcd_file->partial || memcmp(fcd_file_next(_fcd_file), fcd_file_original(_fcd_file), fcd_digest->size))
+        return FCD_RESULT_FAIL;
+      return FCD_RESULT_OK;
+    case FCD_STATE_ERR:
+      return FCD_RESULT_ERR;
+    case FCD_STATE_DEL:
+      return FCD_RESULT_DEL;
+    case FCD_STATE_ADD:
+      return FCD_RESULT_NEW;
+    case FCD_STATE_GONE:
+      return FCD_RESULT_GONE;
+    default:
+      return 0;
+  }
+}
+
+//  the record of a file without ranges (the name is not copied)
+void thread_calculators_launcher_snapshot(struct FCD_MISSION *_mission, struct FCD_RESULT *_result,
+                                          struct FCD_FILE *_fcd_file, int _code) {
+  _result->code = _code;
+  _result->name = _fcd_file->name;
+  memcpy(_result->digest_original, fcd_file_original(_fcd_file), fcd_digest->size);
+  memcpy(_result->digest_next, fcd_file_next(_fcd_file), fcd_digest->size);
+  _result->errnum = _fcd_file->errnum;
+  _result->source = _fcd_file->source;
+  _result->partial = _fcd_file->partial;
+  _result->verified = _mission->etalon.verified ? fcd_file_verified(_fcd_file) : 0;
+  _result->ranges_first = _result->ranges_count = 0;
+}
+
+//  the whole list state goes to JSON-writer, not only the rescanned files;
+//  the next scan starts at once - the report holds a snapshot, not the files
+void thread_calculators_launcher_report(struct FCD_MISSION *_mission) {
+  int integrity_check_ok = 1, code;
+  int64_t statuses[FCD_RESULT_GONE + 1] = {0};
+  int64_t covered = 0, total = 0, oldest = 0;
+  uint64_t changes = 0;
+  uint32_t verified;
+  struct FCD_FILE *fcd_file;
+  struct FCD_RESULT *result;
+  //  waits only if all report buffers are pending in JSON-writer
+  int64_t wait_ns = fcd_clock_ns(CLOCK_MONOTONIC);
+  struct FCD_REPORT *report = fcd_results_open(&_mission->results, _mission->etalon.count);
+  fcd_metrics_add(FCD_METRICS_REPORT_WAIT_NS, fcd_clock_ns(CLOCK_MONOTONIC) - wait_ns);
+  //  the full report only every full-th time, else only the changes
+  report->full = (_mission->reports_count++ % _mission->full == 0);
+  report->time_ns = fcd_clock_ns(CLOCK_REALTIME);
+  report->rolling = _mission->etalon.verified;
+  if (report->rolling) {
+    report->coverage = _mission->cover.coverage;
+    report->coverage.oldest = 0;
+    report->coverage.never = 0;
+  }
+  for (size_t n = 0; n < _mission->etalon.count; ++n) {
+    fcd_file = fcd_etalon_file(&_mission->etalon, n);
+    //  the least recent verification of the etalon files
+    if (report->rolling && fcd_file->state == FCD_STATE_OLD) {
+      if (!(verified = fcd_file_verified(fcd_file))) ++report->coverage.never;
+      else if (!report->coverage.oldest || verified < report->coverage.oldest) report->coverage.oldest = verified;
+    }
+    code = thread_calculators_launcher_code(fcd_file);
+    if (!code) continue;
+    if (code != FCD_RESULT_OK && code != FCD_RESULT_GONE) integrity_check_ok = 0;
+    ++statuses[code];
+    result = &report->records[report->count];
+    result->from = fcd_file->reported;
+    fcd_file->reported = code;
+    //  a file first reported as OK (or already gone) is not a change
+    if (!result->from && (code == FCD_RESULT_OK || code == FCD_RESULT_GONE)) result->from = code;
+    if (result->from != code) ++changes;
+    if (result->from == code && (!report->full || code == FCD_RESULT_GONE)) continue;
+    thread_calculators_launcher_snapshot(_mission, result, fcd_file, code);
+    result->ranges_first = report->ranges_count;
+    if (code == FCD_RESULT_FAIL) thread_calculators_launcher_ranges(report, fcd_file);
+    result->ranges_count = report->ranges_count - result->ranges_first;
+    ++report->count;
+  }
+  fcd_results_push(&_mission->results, report);
+  fcd_metrics_add(FCD_METRICS_CHANGES, changes);
+  //  the gauges are over all missions: files of the etalons (index 0) and statuses
+  statuses[0] = _mission->etalon.count;
+  for (code = 0; code <= FCD_RESULT_GONE; ++code)
+    __atomic_store_n(&_mission->statuses[code], statuses[code], __ATOMIC_RELAXED);
+  if (report->rolling) {
+    __atomic_store_n(&_mission->rolling_covered, report->coverage.covered, __ATOMIC_RELAXED);
+    __atomic_store_n(&_mission->rolling_total, report->coverage.total, __ATOMIC_RELAXED);
+    __atomic_store_n(&_mission->rolling_oldest, report->coverage.oldest, __ATOMIC_RELAXED);
+  }
+  memset(statuses, 0, sizeof(statuses));
+  for (struct FCD_MISSION *mission = fcd_missions; mission; mission = mission->next) {
+    for (code = 0; code <= FCD_RESULT_GONE; ++code)
+      statuses[code] += __atomic_load_n(&mission->statuses[code], __ATOMIC_RELAXED);
+    covered += __atomic_load_n(&mission->rolling_covered, __ATOMIC_RELAXED);
+    total += __atomic_load_n(&mission->rolling_total, __ATOMIC_RELAXED);
+    verified = __atomic_load_n(&mission->rolling_oldest, __ATOMIC_RELAXED);
+    if (verified && (!oldest || verified < oldest)) oldest = verified;
+  }
+  fcd_metrics_set(FCD_METRICS_ETALON_FILES, statuses[0]);
+  fcd_metrics_set(FCD_METRICS_STATUS_OK, statuses[FCD_RESULT_OK]);
+  fcd_metrics_set(FCD_METRICS_STATUS_FAIL, statuses[FCD_RESULT_FAIL]);
+  fcd_metrics_set(FCD_METRICS_STATUS_ERROR, statuses[FCD_RESULT_ERR]);
+  fcd_metrics_set(FCD_METRICS_STATUS_DELETED, statuses[FCD_RESULT_DEL]);
+  fcd_metrics_set(FCD_METRICS_STATUS_NEW, statuses[FCD_RESULT_NEW]);
+  fcd_metrics_set(FCD_METRICS_LAST_SCAN_TIME, report->time_ns / 1000000000);
+  fcd_metrics_set(FCD_METRICS_ROLLING_COVERED, covered);
+  fcd_metrics_set(FCD_METRICS_ROLLING_TOTAL, total);
+  fcd_metrics_set(FCD_METRICS_VERIFIED_OLDEST, oldest ? report->time_ns / 1000000000 - oldest : 0);
+  if (integrity_check_ok) {
+    if (fcd_missions->next) syslog(LOG_NOTICE, "Integrity check: OK (%s)", _mission->path);
+    else syslog(LOG_NOTICE, "Integrity check: OK");
+  }
+}
+
+uint32_t thread_calculators_launcher_etadb_flags(struct FCD_MISSION *_mission) {
+  //  an etalon of another algorithm is another mission
+  return (_mission->recursive ? FCD_ETADB_RECURSIVE : 0) | (uint32_t)fcd_digest_id() << FCD_ETADB_ALGORITHM;
+}
+
+//  returns 1 - the etalon list is loaded, 0 - the initial calculation is needed
+int thread_calculators_launcher_load(struct FCD_MISSION *_mission) {
+  const char *errop;
+  const char *file = _mission->etalon_file;
+  if (!file || _mission->rebase) return 0;
+  int64_t load_ns = fcd_clock_ns(CLOCK_MONOTONIC);
+  int cc = fcd_etadb_load(&_mission->etalon, file, _mission->path, thread_calculators_launcher_etadb_flags(_mission),
+                          _mission->blocks ? mission_chunk : 0, &errop);
+  if (cc == ENOENT) {
+    syslog(LOG_NOTICE, "Etalon database %s not found, initial calculation", file);
+    return 0;
+  }
+  if (cc) {
+    //  corrupted, modified or of another mission - never fall back silently
+    syslog(LOG_ERR, "Etalon database %s: %s: [%i] %s", file, errop, cc, strerror(cc));
+    severe_error_1("Etalon database rejected (start with rebase=1 to calculate a new one)! Program stoped!");
+  }
+  syslog(LOG_NOTICE, "Etalon database %s loaded: %lu files in %.1f ms", file,
+         (unsigned long)_mission->etalon.count, (fcd_clock_ns(CLOCK_MONOTONIC) - load_ns) / 1e6);
+  return 1;
+}
+
+void thread_calculators_launcher_save(struct FCD_MISSION *_mission) {
+  const char *errop;
+  const char *file = _mission->etalon_file;
+  if (!file) return;
+  int cc = fcd_etadb_save(&_mission->etalon, file, _mission->path, thread_calculators_launcher_etadb_flags(_mission),
+                          mission_chunk, &errop);
+  //  the service works on, the next start calculates again
+  if (cc) syslog(LOG_ERR, "Etalon database %s: %s: [%i] %s", file, errop, cc, strerror(cc));
+  else syslog(LOG_NOTICE, "Etalon database %s saved: %lu files", file, (unsigned long)_mission->etalon.count);
+}
+
+//  the cursor and the times of verification of the loaded etalon list (rolling)
+void thread_calculators_launcher_rolling_load(struct FCD_MISSION *_mission) {
+  const char *errop;
+  const char *file = _mission->etalon_file;
+  if (!file || !_mission->etalon.verified) return;
+  int cc = fcd_rolling_load(&_mission->cover, &_mission->etalon, file, &errop);
+  if (cc == ENOENT) syslog(LOG_NOTICE, "Rolling state %s%s not found, new cycle", file, FCD_ROLLING_SUFFIX);
+  else if (cc == ESTALE) syslog(LOG_NOTICE, "Rolling state %s%s of another etalon, new cycle", file, FCD_ROLLING_SUFFIX);
+  //  only the times and the cursor are lost, the service works on
+  else if (cc) syslog(LOG_ERR, "Rolling state %s%s: %s: [%i] %s, new cycle", file, FCD_ROLLING_SUFFIX, errop, cc,
+                      strerror(cc));
+  else syslog(LOG_NOTICE, "Rolling state %s%s loaded: cycle %lu, file %lu of %lu", file, FCD_ROLLING_SUFFIX,
+              (unsigned long)_mission->cover.coverage.cycle, (unsigned long)_mission->cover.cursor,
+              (unsigned long)_mission->etalon.count);
+}
+
+void thread_calculators_launcher_rolling_save(struct FCD_MISSION *_mission) {
+  const char *errop;
+  const char *file = _mission->etalon_file;
+  if (!file) return;
+  int cc = fcd_rolling_save(&_mission->cover, &_mission->etalon, file, &errop);
+  if (cc) syslog(LOG_ERR, "Rolling state %s%s: %s: [%i] %s", file, FCD_ROLLING_SUFFIX, errop, cc, strerror(cc));
+}
+
+//  the slice of the full scan (rolling): its files are read even with the stat() signature unchanged
+void thread_calculators_launcher_rolling(struct FCD_MISSION *_mission) {
+  struct FCD_COVERAGE *coverage = &_mission->cover.coverage;
+  time_t now = time(NULL);
+  int done = fcd_rolling_slice(&_mission->cover, &_mission->etalon, _mission->rolling, _mission->cycle, mission_chunk,
+                               now);
+  _mission->scan_rolling = 1;
+  syslog(LOG_INFO, "Rolling verification %s: cycle %lu, scan %u, %lu of %lu bytes (%.1f%%)", _mission->path,
+         (unsigned long)coverage->cycle, coverage->intervals, (unsigned long)coverage->covered,
+         (unsigned long)coverage->total, coverage->total ? coverage->covered * 100.0 / coverage->total : 100.0);
+  if (done)
+    syslog(LOG_NOTICE, "Rolling verification %s: cycle %lu done in %u scans, %li s", _mission->path,
+           (unsigned long)coverage->cycle, coverage->intervals, (long)(now - coverage->cycle_start));
+}
+
+//  memory of the etalon list: bytes per file in all and of the record (names, slots and bitmap aside)
+void thread_calculators_launcher_memory(struct FCD_MISSION *_mission) {
+  struct FCD_ETALON *etalon = &_mission->etalon;
+  if (!etalon->count) return;
+  syslog(LOG_NOTICE, "Etalon list %s: %lu files, %.1f bytes per file (record %lu, names %.1f)", _mission->path,
+         (unsigned long)etalon->count, (double)fcd_etalon_bytes(etalon) / etalon->count, (unsigned long)etalon->stride,
+         (double)etalon->names_size / etalon->count);
+}
+
+//  the etalon list - loaded from the etalon file or the initial calculation;
+//  returns 1 - loaded (a full scan is due at once), 0 - calculated
+int thread_calculators_launcher_initial(struct FCD_MISSION *_mission) {
+  int64_t scan_start = fcd_clock_ns(CLOCK_MONOTONIC);
+  if (thread_calculators_launcher_load(_mission)) {
+    thread_calculators_launcher_memory(_mission);
+    thread_calculators_launcher_rolling_load(_mission);
+    return 1;
+  }
+  //  initial calculation
+  _mission->scan_initial = 1;
+  thread_calculators_launcher_scan_full(_mission);
+  _mission->scan_initial = 0;
+  thread_calculators_launcher_read_stats(fcd_clock_ns(CLOCK_MONOTONIC) - scan_start);
+  thread_calculators_launcher_adapt(_mission, fcd_clock_ns(CLOCK_MONOTONIC) - scan_start);
+  for (size_t n = 0; n < _mission->etalon.count; ++n) {
+    if (fcd_etalon_file(&_mission->etalon, n)->state == FCD_STATE_ERR)
+      severe_error_1("Initial calculation failed! Program stoped!");
+  }
+  thread_calculators_launcher_memory(_mission);
+  thread_calculators_launcher_save(_mission);
+  return 0;
+}
+
+//  one scan and its report: full - the whole tree (scan_deep is set by the caller),
+//  else only the files named by inotify
+void thread_calculators_launcher_scan(struct FCD_MISSION *_mission, int _full, char **_names, size_t _count) {
+  int64_t scan_start = fcd_clock_ns(CLOCK_MONOTONIC);
+  fcd_etalon_seen_reset(&_mission->etalon);
+  if (_full) {
+    //  a deep verification reads every file anyway
+    if (_mission->etalon.verified && !_mission->scan_deep) thread_calculators_launcher_rolling(_mission);
+    thread_calculators_launcher_scan_full(_mission);
+    fcd_metrics_add(_mission->scan_deep ? FCD_METRICS_SCANS_DEEP : FCD_METRICS_SCANS_FULL, 1);
+  } else {
+    //  files named by a control request - re-hashed
+    _mission->scan_deep = _mission->scan_verify;
+    thread_calculators_launcher_scan_names(_mission, _names, _count);
+    fcd_metrics_add(FCD_METRICS_SCANS_TARGETED, 1);
+  }
+  fcd_metrics_observe(FCD_METRICS_SCAN_NS, fcd_clock_ns(CLOCK_MONOTONIC) - scan_start);
+  thread_calculators_launcher_read_stats(fcd_clock_ns(CLOCK_MONOTONIC) - scan_start);
+  thread_calculators_launcher_adapt(_mission, fcd_clock_ns(CLOCK_MONOTONIC) - scan_start);
+  thread_calculators_launcher_report(_mission);
+  //  the appended blocks for the next start; the rolling state follows the new etalon file
+  int grown = __atomic_exchange_n(&_mission->etalon_grown, 0, __ATOMIC_RELAXED);
+  if (grown) thread_calculators_launcher_save(_mission);
+  //  the cursor and the times of verification of the full scan (a deep one too) for the next start
+  _mission->scan_rolling = 0;
+  if ((_full || grown) && _mission->etalon.verified) thread_calculators_launcher_rolling_save(_mission);
+  //  the metrics file follows every report
+  if (mission_metrics && sem_post(&sem_metrics)) severe_error_0("sem_post(sem_metrics)", errno);
+}
+
+//  the state of the file goes to the reports and the control requests (mutex_etalon is locked)
+void thread_crc32_calculator_finish_locked(struct FCD_MISSION *_mission, struct FCD_FILE *_fcd_file,
+                                           const char *_text, int _errno) {
+  if (!_text) {
+    fcd_metrics_add(_fcd_file->source == FCD_SOURCE_METADATA ? FCD_METRICS_FILES_METADATA : FCD_METRICS_FILES_CONTENT, 1);
+    //  if not initial calculation
+    if (_fcd_file->state != FCD_STATE_NEW) {
+      if (_fcd_file->partial) {
+        syslog(LOG_WARNING, "Integrity check: FAIL (%s/%s - %s of a block differs, verification stopped)",
+               _mission->path, _fcd_file->name, fcd_digest->label);
+      } else if (memcmp(fcd_file_next(_fcd_file), fcd_file_original(_fcd_file), fcd_digest->size)) {
+        char original[FCD_DIGEST_HEX], next[FCD_DIGEST_HEX];
+        fcd_digest_hex(fcd_file_original(_fcd_file), original);
+        fcd_digest_hex(fcd_file_next(_fcd_file), next);
+        syslog(LOG_WARNING, "Integrity check: FAIL (%s/%s - %s <%s,%s>)", _mission->path, _fcd_file->name,
+               fcd_digest->label, original, next);
+      }
+    }
+    _fcd_file->state = FCD_STATE_OLD;
+  } else {
+    fcd_metrics_add(FCD_METRICS_FILES_ERROR, 1);
+    //  if initial calculation
+    if (_fcd_file->state == FCD_STATE_NEW) severe_error_2(_mission->path, _fcd_file->name, _text, _errno);
+    //  keep the error code for the next reports
+    light_error_0(_mission->path, _fcd_file->name, _text, _errno);
+    _fcd_file->errnum = _errno;
+    _fcd_file->state = FCD_STATE_ERR;
+  }
+  //
+  return;
+}
+
+void thread_crc32_calculator_finish(struct FCD_MISSION *_mission, struct FCD_FILE *_fcd_file, const char *_text,
+                                    int _errno) {
+  //  lock mutex
+  if (pthread_mutex_lock(&_mission->mutex_etalon)) severe_error_0("pthread_mutex_lock(mutex_etalon)", errno);
+  thread_crc32_calculator_finish_locked(_mission, _fcd_file, _text, _errno);
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_mission->mutex_etalon)) severe_error_0("pthread_mutex_unlock(mutex_etalon)", errno);
+}
+
+struct FCD_CRC32_CALC {
+    union FCD_DIGEST_STATE state;
+    int64_t cpu_ns;
+    uint64_t bytes;
+};
+
+struct FCD_CRC32_SPLIT;
+
+//  one range of a large file, hashed by any pool thread
+struct FCD_CRC32_PART {
+    struct FCD_CRC32_SPLIT *split;
+    off_t offset;
+    off_t length;
+    int fecc;
+    const char *errop;
+};
+
+struct FCD_CRC32_SPLIT {
+    struct FCD_MISSION *mission;
+    struct FCD_FILE *fcd_file;
+    int fd;
+    struct stat st;
+    int64_t start_ns;
+    int parts_count;
+    int parts_left;
+    //  parts read [part_first, part_last), the others are taken as they are: the etalon blocks before
+    //  the old end of file (verify=append), the blocks of the last calculation out of the rolling slice
+    int part_first;
+    int part_last;
+    int appended;
+    //  the time of verification of the whole file (rolling), 0 - not all of it is read
+    uint32_t verified;
+    //  early verification - a block differs, parts not started yet are skipped
+    int stop;
+    //  part values in file order (for fcd_digest->merge), then the block values of the file
+    struct FCD_DIGEST_PART *digests;
+    struct FCD_CRC32_PART parts[];
+};
+
+//  one block of the file from the read engine
+void thread_crc32_calculator_consume(void *_ctx, const unsigned char *_buf, size_t _len) {
+  struct FCD_CRC32_CALC *calc = _ctx;
+  fcd_digest->update(&calc->state, _buf, _len);
+  calc->bytes += _len;
+  fcd_metrics_add(FCD_METRICS_BYTES, _len);
+  //  keep within I/O & CPU budgets, the time slept goes to the metrics
+  int64_t wait = fcd_budget_take(&io_budget, _len);
+  if (wait) fcd_metrics_add(FCD_METRICS_IO_WAIT_NS, wait);
+  if (cpu_budget.rate > 0) {
+    int64_t cpu_now = fcd_clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    wait = fcd_budget_take(&cpu_budget, cpu_now - calc->cpu_ns);
+    if (wait) fcd_metrics_add(FCD_METRICS_CPU_WAIT_NS, wait);
+    calc->cpu_ns = cpu_now;
+  }
+}
+
+//  read [offset, offset+length) of the open file into calc (length < 0 - up to the end of file)
+int thread_crc32_calculator_range(struct FCD_WORKER *_worker, int _fd, const struct stat *_st,
+                                  struct FCD_CRC32_CALC *_calc, off_t _offset, off_t _length, const char **_errop) {
+  struct FCD_READ reading = {
+    .fd = _fd, .size = _st->st_size, .offset = _offset, .length = _length,
+    .buff = _worker->buff, .buff_size = _worker->buff_size,
+    .consume = &thread_crc32_calculator_consume, .ctx = _calc
+  };
+  int fecc = fcd_read(mission_read, &reading);
+  *_errop = reading.errop;
+  return fecc;
+}
+
+//  the block values of the calculation go to the file (the array is taken over), to the etalon
+//  too on the initial calculation or when the etalon grows (verify=append)
+void thread_crc32_calculator_blocks(struct FCD_FILE *_fcd_file, struct FCD_DIGEST_PART *_digests, size_t _count,
+                                    int _etalon) {
+  struct FCD_BLOCKS *blocks = _fcd_file->blocks;
+  if (!blocks) {
+    blocks = _fcd_file->blocks = my_malloc(sizeof(struct FCD_BLOCKS));
+    memset(blocks, 0, sizeof(struct FCD_BLOCKS));
+  }
+  free(blocks->next);
+  blocks->next = _digests;
+  blocks->next_count = _count;
+  if (_etalon) {
+    free(blocks->original);
+    blocks->original = NULL;
+    if (_count) {
+      blocks->original = my_malloc(sizeof(struct FCD_DIGEST_PART) * _count);
+      memcpy(blocks->original, _digests, sizeof(struct FCD_DIGEST_PART) * _count);
+    }
+    blocks->original_count = _count;
+  }
+}
+
+//  1 - the block value differs from the etalon one (0 - no etalon blocks to compare with)
+int thread_crc32_calculator_block_differs(struct FCD_FILE *_fcd_file, size_t _n,
+                                          const struct FCD_DIGEST_PART *_digest) {
+  struct FCD_BLOCKS *blocks = _fcd_file->blocks;
+  if (!blocks || !blocks->original_count) return 0;
+  if (_n >= blocks->original_count) return 1;
+  return blocks->original[_n].bytes != _digest->bytes ||
+         memcmp(blocks->original[_n].value, _digest->value, fcd_digest->size) != 0;
+}
+
+//  the value of the whole file, _verified - the time for the rolling verification (0 - not all of it
+//  is read); mutex_etalon is locked - control requests see the whole result or none of it
+void thread_crc32_calculator_result_locked(struct FCD_MISSION *_mission, struct FCD_FILE *_fcd_file,
+                                           const struct stat *_st, const unsigned char *_digest, int _etalon,
+                                           uint32_t _verified) {
+  if (_etalon) memcpy(fcd_file_original(_fcd_file), _digest, fcd_digest->size);
+  memcpy(fcd_file_next(_fcd_file), _digest, fcd_digest->size);
+  _fcd_file->partial = 0;
+  _fcd_file->source = FCD_SOURCE_CONTENT;
+  fcd_stat_sig(&_fcd_file->sig, _st);
+  if (_mission->etalon.verified && _verified) fcd_file_verified_set(_fcd_file, _verified);
+  thread_crc32_calculator_finish_locked(_mission, _fcd_file, NULL, 0);
+}
+
+//  all parts are done - glue part values in file order
+void thread_crc32_calculator_merge(struct FCD_CRC32_SPLIT *_split) {
+  int fecc = 0;
+  const char *errop = NULL;
+  unsigned char digest[FCD_DIGEST_MAX];
+  struct FCD_MISSION *mission = _split->mission;
+  struct FCD_FILE *fcd_file = _split->fcd_file;
+  for (int i = 0; i < _split->parts_count; ++i) {
+    struct FCD_CRC32_PART *part = &_split->parts[i];
+    if (part->fecc && !fecc) {
+      fecc = part->fecc;
+      errop = part->errop;
+    }
+  }
+  if (close(_split->fd)) {
+    thread_crc32_calculator_finish(mission, fcd_file, "close", errno);
+  } else if (fecc) {
+    thread_crc32_calculator_finish(mission, fcd_file, errop, fecc);
+  } else if (_split->stop) {
+    //  lock mutex
+    if (pthread_mutex_lock(&mission->mutex_etalon)) severe_error_0("pthread_mutex_lock(mutex_etalon)", errno);
+    //  early verification - no value of the whole file, the blocks show what was checked
+    thread_crc32_calculator_blocks(fcd_file, _split->digests, _split->parts_count, 0);
+    _split->digests = NULL;
+    fcd_file->partial = 1;
+    fcd_file->source = FCD_SOURCE_CONTENT;
+    fcd_stat_sig(&fcd_file->sig, &_split->st);
+    thread_crc32_calculator_finish_locked(mission, fcd_file, NULL, 0);
+    //  unlock mutex
+    if (pthread_mutex_unlock(&mission->mutex_etalon)) severe_error_0("pthread_mutex_unlock(mutex_etalon)", errno);
+  } else {
+    fcd_digest->merge(_split->digests, _split->parts_count, mission_chunk, digest);
+    //  the appended file is the new etalon (verify=append)
+    int etalon = fcd_file->state == FCD_STATE_NEW || _split->appended;
+    if (_split->appended) {
+      fcd_metrics_add(FCD_METRICS_FILES_APPENDED, 1);
+      __atomic_store_n(&mission->etalon_grown, 1, __ATOMIC_RELAXED);
+      syslog(LOG_INFO, "Integrity check: APPEND (%s/%s - %ld bytes appended)", mission->path, fcd_file->name,
+             (long)(_split->st.st_size - fcd_file->sig.size));
+    }
+    //  lock mutex
+    if (pthread_mutex_lock(&mission->mutex_etalon)) severe_error_0("pthread_mutex_lock(mutex_etalon)", errno);
+    if (mission->blocks && _split->st.st_size >= mission->blocks) {
+      thread_crc32_calculator_blocks(fcd_file, _split->digests, _split->parts_count, etalon);
+      _split->digests = NULL;
+    } else if (fcd_file->blocks) {
+      thread_crc32_calculator_blocks(fcd_file, NULL, 0, etalon);
+    }
+    thread_crc32_calculator_result_locked(mission, fcd_file, &_split->st, digest, etalon, _split->verified);
+    //  unlock mutex
+    if (pthread_mutex_unlock(&mission->mutex_etalon)) severe_error_0("pthread_mutex_unlock(mutex_etalon)", errno);
+  }
+  fcd_metrics_observe(FCD_METRICS_FILE_NS, fcd_clock_ns(CLOCK_MONOTONIC) - _split->start_ns);
+  free(_split->digests);
+  free(_split);
+}
+
+void thread_crc32_calculator_part(struct FCD_WORKER *_worker, void *_arg) {
+  struct FCD_CRC32_PART *part = _arg;
+  struct FCD_CRC32_SPLIT *split = part->split;
+  size_t n = part - split->parts;
+  struct FCD_DIGEST_PART *digest = &split->digests[n];
+  if (__atomic_load_n(&split->stop, __ATOMIC_ACQUIRE)) {
+    //  early verification - the file fails already
+    digest->bytes = FCD_BLOCK_SKIPPED;
+  } else {
+    struct FCD_CRC32_CALC calc;
+    fcd_digest->init(&calc.state, part->offset);
+    calc.cpu_ns = fcd_clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    calc.bytes = 0;
+    part->fecc = thread_crc32_calculator_range(_worker, split->fd, &split->st, &calc, part->offset, part->length,
+                                               &part->errop);
+    fcd_digest->part(&calc.state, digest->value);
+    digest->bytes = calc.bytes;
+    __atomic_add_fetch(&split->mission->bytes_read, calc.bytes, __ATOMIC_RELAXED);
+    fcd_metrics_add(FCD_METRICS_PARTS, 1);
+    if (split->mission->verify == FCD_VERIFY_EARLY && !part->fecc && split->fcd_file->state != FCD_STATE_NEW &&
+        thread_crc32_calculator_block_differs(split->fcd_file, n, digest))
+      __atomic_store_n(&split->stop, 1, __ATOMIC_RELEASE);
+  }
+  //  the last finished part merges (split is freed there)
+  if (__atomic_sub_fetch(&split->parts_left, 1, __ATOMIC_ACQ_REL) == 0) thread_crc32_calculator_merge(split);
+}
+
+//  large file - ranges for the whole pool, the fd is shared (pread does not move the offset);
+//  only the parts [first, last) are read, the others are the blocks kept: of the etalon before the
+//  old end of file (verify=append, appended), of the last calculation out of the rolling slice
+void thread_crc32_calculator_split(struct FCD_WORKER *_worker, struct FCD_MISSION *_mission, struct FCD_FILE *_fcd_file,
+                                   int _fd, const struct stat *_st, int _first, int _last,
+                                   const struct FCD_DIGEST_PART *_kept, int _appended, uint32_t _verified,
+                                   int64_t _start_ns) {
+  int count = (_st->st_size + mission_chunk - 1) / mission_chunk;
+  struct FCD_CRC32_SPLIT *split = my_malloc(sizeof(struct FCD_CRC32_SPLIT) + sizeof(struct FCD_CRC32_PART) * count);
+  split->digests = my_malloc(sizeof(struct FCD_DIGEST_PART) * count);
+  split->mission = _mission;
+  split->fcd_file = _fcd_file;
+  split->fd = _fd;
+  split->st = *_st;
+  split->start_ns = _start_ns;
+  split->parts_count = count;
+  split->parts_left = _last - _first;
+  split->part_first = _first;
+  split->part_last = _last;
+  split->appended = _appended;
+  split->verified = _verified;
+  split->stop = 0;
+  for (int i = 0; i < count; ++i) {
+    struct FCD_CRC32_PART *part = &split->parts[i];
+    memset(part, 0, sizeof(*part));
+    part->split = split;
+    part->offset = (off_t)i * mission_chunk;
+    //  the last part reads up to the end of file, as the sequential calculation does
+    part->length = i == count - 1 ? -1 : mission_chunk;
+  }
+  if (_first) memcpy(split->digests, _kept, sizeof(struct FCD_DIGEST_PART) * _first);
+  if (_last < count) memcpy(split->digests + _last, _kept + _last, sizeof(struct FCD_DIGEST_PART) * (count - _last));
+  //  the first read part is still pending, so split stays alive during the loop
+  for (int i = _first + 1; i < _last; ++i) {
+    //  the queue is full or the mission used its share - hash the part here
+    if (!fcd_pool_try_submit(crc32_pool, &_mission->group, &thread_crc32_calculator_part, &split->parts[i]))
+      thread_crc32_calculator_part(_worker, &split->parts[i]);
+  }
+  thread_crc32_calculator_part(_worker, &split->parts[_first]);
+}
+
+//  verify=append: the number of etalon blocks kept for a file that has only grown (0 - read it all);
+//  a change before the old end of file is caught by the deep verification
+int thread_crc32_calculator_appended(struct FCD_MISSION *_mission, struct FCD_FILE *_fcd_file, const struct stat *_st) {
+  struct FCD_BLOCKS *blocks = _fcd_file->blocks;
+  if (_mission->verify != FCD_VERIFY_APPEND || _mission->scan_deep || _fcd_file->state != FCD_STATE_OLD) return 0;
+  //  the last check was OK
+  if (!blocks || !blocks->original_count || _fcd_file->partial ||
+      memcmp(fcd_file_next(_fcd_file), fcd_file_original(_fcd_file), fcd_digest->size))
+    return 0;
+  //  the same file, only longer
+  if (fcd_stat_dev(_st->st_dev) != _fcd_file->sig.dev || _st->st_ino != _fcd_file->sig.ino || _st->st_size <= _fcd_file->sig.size)
+    return 0;
+  size_t kept = _fcd_file->sig.size / mission_chunk;
+  return kept < blocks->original_count ? kept : blocks->original_count;
+}
+
+void thread_crc32_calculator_entry_point(struct FCD_WORKER *_worker, void *_arg) {
+  int fd, fecc, kept, parts;
+  struct stat st;
+  const char *errop;
+  int64_t start_ns;
+  uint64_t from, to;
+  uint32_t verified;
+  struct FCD_FILE *fcd_file = _arg;
+  struct FCD_MISSION *mission = _worker->group->owner;
+  int sampled = thread_calculators_launcher_sampled(mission, fcd_file, &from, &to);
+  //  fast path - stat() signature unchanged since the last calculation (and not in the rolling slice)
+  if (!mission->scan_deep && fcd_file->state == FCD_STATE_OLD) {
+    if (fstatat(mission->dirfd, fcd_file->name, &st, 0) == 0 && fcd_stat_equal(&fcd_file->sig, &st)) {
+      if (!sampled) {
+        //  lock mutex
+        if (pthread_mutex_lock(&mission->mutex_etalon)) severe_error_0("pthread_mutex_lock(mutex_etalon)", errno);
+        fcd_file->source = FCD_SOURCE_METADATA;
+        thread_crc32_calculator_finish_locked(mission, fcd_file, NULL, 0);
+        //  unlock mutex
+        if (pthread_mutex_unlock(&mission->mutex_etalon)) severe_error_0("pthread_mutex_unlock(mutex_etalon)", errno);
+        return;
+      }
+    } else {
+      //  changed - the whole file at once
+      sampled = 0;
+    }
+  }
+  start_ns = fcd_clock_ns(CLOCK_MONOTONIC);
+  verified = time(NULL);
+  fd = openat(mission->dirfd, fcd_file->name, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    thread_crc32_calculator_finish(mission, fcd_file, "open", errno);
+    return;
+  }
+  //  signature before reading - a change during reading is caught next scan
+  if (fstat(fd, &st)) {
+    fecc = errno;
+    close(fd);
+    thread_crc32_calculator_finish(mission, fcd_file, "fstat", fecc);
+    return;
+  }
+  //  parts for the pool, or block values for the etalon
+  parts = (st.st_size + mission_chunk - 1) / mission_chunk;
+  if (sampled && (from || to < (uint64_t)st.st_size) && fcd_stat_equal(&fcd_file->sig, &st) && !fcd_file->partial &&
+      fcd_file->blocks && fcd_file->blocks->original_count == (size_t)parts &&
+      fcd_file->blocks->next_count == (size_t)parts) {
+    //  the blocks of the rolling slice, the others as the last calculation found them (a FAIL stays);
+    //  the file is checked whole by the slice that reads its end
+    thread_crc32_calculator_split(_worker, mission, fcd_file, fd, &st, from / mission_chunk,
+                                  (to + mission_chunk - 1) / mission_chunk, fcd_file->blocks->next, 0,
+                                  to < (uint64_t)st.st_size ? 0 : mission->cover.start_since, start_ns);
+    return;
+  }
+  kept = thread_crc32_calculator_appended(mission, fcd_file, &st);
+  if (kept || (fcd_digest->split && st.st_size > mission_chunk &&
+               ((mission_split && st.st_size >= mission_split) || (mission->blocks && st.st_size >= mission->blocks)))) {
+    thread_crc32_calculator_split(_worker, mission, fcd_file, fd, &st, kept, parts,
+                                  kept ? fcd_file->blocks->original : NULL, kept != 0, kept ? 0 : verified, start_ns);
+    return;
+  }
+  struct FCD_CRC32_CALC calc;
+  unsigned char digest[FCD_DIGEST_MAX];
+  fcd_digest->init(&calc.state, 0);
+  calc.cpu_ns = fcd_clock_ns(CLOCK_THREAD_CPUTIME_ID);
+  calc.bytes = 0;
+  fecc = thread_crc32_calculator_range(_worker, fd, &st, &calc, 0, -1, &errop);
+  __atomic_add_fetch(&mission->bytes_read, calc.bytes, __ATOMIC_RELAXED);
+  if (close(fd)) {
+    thread_crc32_calculator_finish(mission, fcd_file, "close", errno);
+    return;
+  }
+  if (fecc) {
+    thread_crc32_calculator_finish(mission, fcd_file, errop, fecc);
+    return;
+  }
+  fcd_digest->final(&calc.state, digest);
+  //  lock mutex
+  if (pthread_mutex_lock(&mission->mutex_etalon)) severe_error_0("pthread_mutex_lock(mutex_etalon)", errno);
+  //  a file hashed whole has no blocks
+  if (fcd_file->blocks) thread_crc32_calculator_blocks(fcd_file, NULL, 0, fcd_file->state == FCD_STATE_NEW);
+  thread_crc32_calculator_result_locked(mission, fcd_file, &st, digest, fcd_file->state == FCD_STATE_NEW, verified);
+  //  unlock mutex
+  if (pthread_mutex_unlock(&mission->mutex_etalon)) severe_error_0("pthread_mutex_unlock(mutex_etalon)", errno);
+  fcd_metrics_observe(FCD_METRICS_FILE_NS, fcd_clock_ns(CLOCK_MONOTONIC) - start_ns);
+}
+
+//  the elevator order: every job reads the next file of the sorted list up to its end
+void thread_crc32_calculator_elevator(struct FCD_WORKER *_worker, void *_arg) {
+  struct FCD_MISSION *mission = _worker->group->owner;
+  struct FCD_ELEVATOR *elevator = &mission->elevator;
+  size_t n;
+  (void)_arg;
+  while ((n = __atomic_fetch_add(&elevator->next, 1, __ATOMIC_RELAXED)) < elevator->count)
+    thread_crc32_calculator_entry_point(_worker, elevator->items[n].file);
+}
+
+const char *json_status_names[] = {"", "OK", "ERROR", "DELETED", "NEW", "FAIL", "GONE"};
+
+//  {"path":"mission_path/name"
+void thread_json_writer_path(struct FCD_MISSION *_mission, struct FCD_JSON *_json, struct FCD_RESULT *_result) {
+  fcd_json_literal(_json, "{\"path\":\"");
+  fcd_json_string(_json, _mission->path);
+  fcd_json_literal(_json, "/");
+  fcd_json_string(_json, _result->name);
+  fcd_json_literal(_json, "\"");
+}
+
+//  ,"changed":[[start,end],...] - byte ranges of the kind
+void thread_json_writer_ranges(struct FCD_JSON *_json, struct FCD_REPORT *_report, struct FCD_RESULT *_result,
+                               int _unverified) {
+  int first = 1;
+  for (size_t i = 0; i < _result->ranges_count; ++i) {
+    struct FCD_RANGE *range = &_report->ranges[_result->ranges_first + i];
+    if (range->unverified != _unverified) continue;
+    if (first && _unverified) fcd_json_literal(_json, ",\"unverified\":[[");
+    else if (first) fcd_json_literal(_json, ",\"changed\":[[");
+    else fcd_json_literal(_json, "],[");
+    first = 0;
+    fcd_json_uint64(_json, range->start);
+    fcd_json_literal(_json, ",");
+    fcd_json_uint64(_json, range->end);
+  }
+  if (!first) fcd_json_literal(_json, "]]");
+}
+
+//  ,"algorithm":"crc32","etalon_crc32":"0x...","result_crc32":"0x...","source":"..."[,"changed":[...]]
+void thread_json_writer_digest(struct FCD_JSON *_json, struct FCD_REPORT *_report, struct FCD_RESULT *_result) {
+  char hex[FCD_DIGEST_HEX];
+  fcd_json_literal(_json, ",\"algorithm\":\"");
+  fcd_json_string(_json, fcd_digest->name);
+  fcd_json_literal(_json, "\",\"etalon_");
+  fcd_json_string(_json, fcd_digest->name);
+  fcd_json_literal(_json, "\":\"");
+  fcd_digest_hex(_result->digest_original, hex);
+  fcd_json_put(_json, hex, strlen(hex));
+  fcd_json_literal(_json, "\",\"result_");
+  fcd_json_string(_json, fcd_digest->name);
+  if (_result->partial) {
+    //  early verification - no value of the whole file
+    fcd_json_literal(_json, "\":null");
+  } else {
+    fcd_json_literal(_json, "\":\"");
+    fcd_digest_hex(_result->digest_next, hex);
+    fcd_json_put(_json, hex, strlen(hex));
+    fcd_json_literal(_json, "\"");
+  }
+  if (_result->source == FCD_SOURCE_METADATA) fcd_json_literal(_json, ",\"source\":\"metadata\"");
+  else fcd_json_literal(_json, ",\"source\":\"content\"");
+  thread_json_writer_ranges(_json, _report, _result, 0);
+  thread_json_writer_ranges(_json, _report, _result, 1);
+}
+
+//  ,"verified_age":seconds - since the file was checked whole (rolling), null - not known
+void thread_json_writer_verified(struct FCD_MISSION *_mission, struct FCD_JSON *_json, struct FCD_REPORT *_report,
+                                 struct FCD_RESULT *_result) {
+  if (!_mission->etalon.verified) return;
+  int64_t now = _report ? _report->time_ns / 1000000000 : time(NULL);
+  if (!_result->verified) {
+    fcd_json_literal(_json, ",\"verified_age\":null");
+    return;
+  }
+  fcd_json_literal(_json, ",\"verified_age\":");
+  fcd_json_uint64(_json, now > _result->verified ? now - _result->verified : 0);
+}
+
+//  {"path":...,"status":...} - a record of the full report (and of control.c)
+void thread_json_writer_record(struct FCD_MISSION *_mission, struct FCD_JSON *_json, struct FCD_REPORT *_report,
+                               struct FCD_RESULT *_result) {
+  char strerrt[1024];
+  thread_json_writer_path(_mission, _json, _result);
+  switch (_result->code) {
+    case FCD_RESULT_OK: //  normal status
+    case FCD_RESULT_FAIL:
+      thread_json_writer_digest(_json, _report, _result);
+      thread_json_writer_verified(_mission, _json, _report, _result);
+      if (_result->code == FCD_RESULT_OK) fcd_json_literal(_json, ",\"status\":\"OK\"}");
+      else fcd_json_literal(_json, ",\"status\":\"FAIL\"}");
+      break;
+    case FCD_RESULT_ERR: //  error status
+      strerror_r(_result->errnum, strerrt, sizeof(strerrt));
+      fcd_json_literal(_json, ",\"status\":\"");
+      fcd_json_string(_json, strerrt);
+      fcd_json_literal(_json, "\"}");
+      break;
+    case FCD_RESULT_DEL: //  deleted file
+      fcd_json_literal(_json, ",\"status\":\"DELETED\"}");
+      break;
+    case FCD_RESULT_NEW: //  file not from the etalon
+      fcd_json_literal(_json, ",\"status\":\"NEW\"}");
+      break;
+    case FCD_RESULT_GONE: //  deleted and reported (control.c)
+      fcd_json_literal(_json, ",\"status\":\"GONE\"}");
+      break;
+    default:  //  unknown status-code
+      syslog(LOG_ERR, "report: unknown record code 0x%08X (%i)", _result->code, _result->code);
+      exit(EXIT_FAILURE);
+  }
+}
+
+//  {"rolling":{"cycle":...,...}} - the progress of the rolling cycle, the first element of the full report
+void thread_json_writer_coverage(struct FCD_JSON *_json, struct FCD_REPORT *_report) {
+  struct FCD_COVERAGE *coverage = &_report->coverage;
+  int64_t now = _report->time_ns / 1000000000;
+  //  tenths of a percent, no printf()
+  uint64_t permille = coverage->total ? (uint64_t)(coverage->covered * 1000.0 / coverage->total + 0.5) : 1000;
+  char tenth[2] = {'.', '0' + permille % 10};
+  fcd_json_literal(_json, "{\"rolling\":{\"cycle\":");
+  fcd_json_uint64(_json, coverage->cycle);
+  fcd_json_literal(_json, ",\"scans\":");
+  fcd_json_uint64(_json, coverage->intervals);
+  fcd_json_literal(_json, ",\"covered\":");
+  fcd_json_uint64(_json, coverage->covered);
+  fcd_json_literal(_json, ",\"total\":");
+  fcd_json_uint64(_json, coverage->total);
+  fcd_json_literal(_json, ",\"percent\":");
+  fcd_json_uint64(_json, permille / 10);
+  fcd_json_put(_json, tenth, sizeof(tenth));
+  fcd_json_literal(_json, ",\"cycle_start\":");
+  if (coverage->cycle_start) fcd_json_uint64(_json, coverage->cycle_start);
+  else fcd_json_literal(_json, "null");
+  fcd_json_literal(_json, ",\"cycle_last\":");
+  if (coverage->cycle_last) fcd_json_uint64(_json, coverage->cycle_last);
+  else fcd_json_literal(_json, "null");
+  fcd_json_literal(_json, ",\"oldest_age\":");
+  if (coverage->oldest) fcd_json_uint64(_json, now > coverage->oldest ? now - coverage->oldest : 0);
+  else fcd_json_literal(_json, "null");
+  fcd_json_literal(_json, ",\"never\":");
+  fcd_json_uint64(_json, coverage->never);
+  fcd_json_literal(_json, "}}");
+}
+
+//  the full report - json-file is replaced at once
+void thread_json_writer_full(struct FCD_MISSION *_mission, struct FCD_JSON *_json, struct FCD_REPORT *_report) {
+  struct FCD_RESULT* result;
+  int first = 1;
+  //  the report goes to json.tmp first
+  fcd_json_open(_json);
+  //  write json-header
+  fcd_json_literal(_json, "[\n");
+  if (_report->rolling) {
+    fcd_json_literal(_json, " ");
+    thread_json_writer_coverage(_json, _report);
+    fcd_json_literal(_json, "\n");
+    first = 0;
+  }
+  for (size_t i = 0; i < _report->count; ++i) {
+    result = &_report->records[i];
+    if (result->code == FCD_RESULT_GONE) continue;
+    if (first) fcd_json_literal(_json, " ");
+    else fcd_json_literal(_json, ",");
+    first = 0;
+    thread_json_writer_record(_mission, _json, _report, result);
+    fcd_json_literal(_json, "\n");
+  }
+  //  write json-footer
+  fcd_json_literal(_json, "]\n");
+  //  replace json-file at once
+  fcd_json_commit(_json);
+}
+
+//  {"seq":...,"path":...,"from":...,"status":...} - a line of the changes log (and of control.c watchers)
+void thread_json_writer_change(struct FCD_MISSION *_mission, struct FCD_JSON *_json, struct FCD_REPORT *_report,
+                               struct FCD_RESULT *_result) {
+  char strerrt[1024];
+  char millis[4];
+  uint64_t ms = _report->time_ns / 1000000;
+  millis[0] = '.';
+  millis[1] = '0' + ms % 1000 / 100;
+  millis[2] = '0' + ms % 100 / 10;
+  millis[3] = '0' + ms % 10;
+  fcd_json_literal(_json, "{\"seq\":");
+  fcd_json_uint64(_json, _report->seq);
+  fcd_json_literal(_json, ",\"time\":");
+  fcd_json_uint64(_json, ms / 1000);
+  fcd_json_put(_json, millis, sizeof(millis));
+  fcd_json_literal(_json, ",\"path\":\"");
+  fcd_json_string(_json, _mission->path);
+  fcd_json_literal(_json, "/");
+  fcd_json_string(_json, _result->name);
+  if (_result->from) {
+    fcd_json_literal(_json, "\",\"from\":\"");
+    fcd_json_string(_json, json_status_names[_result->from]);
+    fcd_json_literal(_json, "\",\"status\":\"");
+  } else {
+    //  the first report of the file
+    fcd_json_literal(_json, "\",\"from\":null,\"status\":\"");
+  }
+  fcd_json_string(_json, json_status_names[_result->code]);
+  fcd_json_literal(_json, "\"");
+  if (_result->code == FCD_RESULT_OK || _result->code == FCD_RESULT_FAIL) {
+    thread_json_writer_digest(_json, _report, _result);
+    thread_json_writer_verified(_mission, _json, _report, _result);
+  } else if (_result->code == FCD_RESULT_ERR) {
+    strerror_r(_result->errnum, strerrt, sizeof(strerrt));
+    fcd_json_literal(_json, ",\"error\":\"");
+    fcd_json_string(_json, strerrt);
+    fcd_json_literal(_json, "\"");
+  }
+  fcd_json_literal(_json, "}\n");
+}
+
+//  one NDJSON line per status change
+void thread_json_writer_changes(struct FCD_MISSION *_mission, struct FCD_JSON *_log, struct FCD_REPORT *_report) {
+  fcd_json_log_open(_log, _mission->rotate);
+  for (size_t i = 0; i < _report->count; ++i)
+    if (_report->records[i].from != _report->records[i].code)
+      thread_json_writer_change(_mission, _log, _report, &_report->records[i]);
+  fcd_json_log_flush(_log);
+}
+
+//  one thread per mission, the argument is the mission
+_Noreturn void *thread_json_writer_entry_point(void *_arg) {
+  struct FCD_MISSION *mission = _arg;
+  struct FCD_JSON json, changes;
+  struct FCD_REPORT* report;
+  fcd_json_init(&json, mission->json, ".tmp");
+  if (mission->changes) fcd_json_init(&changes, mission->changes, ".1");
+  while(1) {
+    //  wait for the next report (strictly in scan order)
+    report = fcd_results_take(&mission->results);
+    int64_t write_ns = fcd_clock_ns(CLOCK_MONOTONIC);
+    if (report->full) thread_json_writer_full(mission, &json, report);
+    if (mission->changes) thread_json_writer_changes(mission, &changes, report);
+    fcd_control_publish(mission, report);
+    fcd_metrics_observe(FCD_METRICS_REPORT_NS, fcd_clock_ns(CLOCK_MONOTONIC) - write_ns);
+    fcd_metrics_add(report->full ? FCD_METRICS_REPORTS_FULL : FCD_METRICS_REPORTS, 1);
+    //  the buffer is free for the next scan
+    fcd_results_release(&mission->results, report);
+  }
+}
+
+//  the metrics file is rewritten after every report and on SIGUSR2
+_Noreturn void *thread_metrics_writer_entry_point(void *_arg) {
+  struct FCD_JSON out;
+  size_t pending, level;
+  fcd_json_init(&out, mission_metrics, ".tmp");
+  while(1) {
+    while (sem_wait(&sem_metrics))
+      if (errno != EINTR) severe_error_0("sem_wait(sem_metrics)", errno);
+    //  all requests posted meanwhile go to this write
+    while (sem_trywait(&sem_metrics) == 0);
+    fcd_metrics_set(FCD_METRICS_POOL_QUEUE, fcd_pool_depth(crc32_pool));
+    fcd_metrics_set(FCD_METRICS_POOL_PENDING, fcd_pool_pending(crc32_pool));
+    fcd_metrics_set(FCD_METRICS_POOL_THREADS, mission_threads);
+    pending = level = 0;
+    for (struct FCD_MISSION *mission = fcd_missions; mission; mission = mission->next) {
+      pending += fcd_results_pending(&mission->results);
+      level += __atomic_load_n(&mission->level, __ATOMIC_RELAXED);
+    }
+    fcd_metrics_set(FCD_METRICS_REPORTS_PENDING, pending);
+    fcd_metrics_set(FCD_METRICS_CONCURRENCY, level);
+    fcd_json_open(&out);
+    fcd_metrics_text(&out);
+    fcd_json_commit(&out);
+  }
+}
@@ -0,0 +1,177 @@
+/*
+ *  File Check Daemon - миссия: сканирование каталога, расчёт, отчёты
+ *
+ *  - общие параметры процесса (mission_*): пул потоков, бюджеты I/O и CPU, движок
+ *    чтения, части больших файлов, алгоритм, метрики
+ *  - миссия (struct FCD_MISSION, список fcd_missions) - свои параметры (path,
+ *    interval, json, ...) и состояние: эталонный список, группа заданий пула,
+ *    очередь отчётов, наблюдения inotify, семафор поводов для сканирования
+ *  - fcd_mission_init() - бюджеты, движки чтения, устройства миссий, общий пул;
+ *    fcd_mission_new() - миссия с параметрами по умолчанию, fcd_mission_start() - её состояние
+ *  - уровень параллельности миссии (слоты её группы) - по устройству каталога (device.c),
+ *    потом подстраивается по скорости чтения сканирований; concurrency - постоянный уровень
+ *  - полное сканирование с order (не readdir) читает файлы обхода в порядке их места на
+ *    диске (elevator.c): сначала весь обход, потом расчёт
+ *  - rolling/cycle - полное сканирование ещё читает срез эталонных файлов (rolling.c), курсор
+ *    и времена проверки - в файле etalon.rolling, ход цикла - в каждом отчёте
+ *  - файлы открываются относительно дескриптора каталога миссии (dirfd), рабочий
+ *    каталог процесса не меняется
+ *  - thread_calculators_launcher_initial() - эталонный список (файл etalon или
+ *    первичный расчёт), thread_calculators_launcher_scan() - одно сканирование и отчёт
+ *  - запросы control.c (fcd_touched_request()) идут в список touched, как события
+ *    inotify; номер запроса (ticket) - дождаться сканирования, которое его взяло
+ *  - не зависит от режима демона: сигналы, таймер и main() - в main.c, поэтому
+ *    то же сканирование вызывает и ficheda_bench (bench.c)
+ */
+#ifndef FICHEDA_MISSION_H
+#define FICHEDA_MISSION_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "device.h"
+#include "elevator.h"
+#include "etalon.h"
+#include "json.h"
+#include "pool.h"
+#include "reader.h"
+#include "results.h"
+#include "rolling.h"
+#include "tree.h"
+
+#define FIN_BUFF_SIZE     1048576
+#define CRC_THREADS_MAX   256
+#define CRC_BATCH_SIZE    64
+#define DEEP_INTERVAL     86400
+#define SCAN_DEBOUNCE     100
+#define SCAN_GAP          1000
+#define SPLIT_SIZE        (256l * 1048576)
+#define SPLIT_CHUNK       (64l * 1048576)
+#define CHANGES_ROTATE    (64l * 1048576)
+#define FCD_VERIFY_FULL   0
+#define FCD_VERIFY_EARLY  1
+#define FCD_VERIFY_APPEND 2
+#define FCD_ADAPT_BYTES   (64l * 1048576)
+#define FCD_ADAPT_GAIN    0.05
+
+struct FCD_MISSION {
+    struct FCD_MISSION *next;
+    //  parameters
+    char *name;
+    char *path;
+    char *json;
+    int interval;
+    int deep;
+    int debounce;
+    int gap;
+    int recursive;
+    char *etalon_file;
+    int rebase;
+    int reports;
+    char *changes;
+    long rotate;
+    int full;
+    long blocks;
+    int verify;
+    int concurrency;
+    int order;
+    long rolling;
+    int cycle;
+    //  state
+    int dirfd;
+    struct FCD_ETALON etalon;
+    //  the list grows under it, the result of a file (state, values, signature) is written under it
+    pthread_mutex_t mutex_etalon;
+    //  the etalon grew in this scan (verify=append) - the etalon file is written after the report
+    int etalon_grown;
+    struct FCD_POOL_GROUP group;
+    //  jobs at once (the slots of the group): the device, the level and its tuning
+    struct FCD_DEVICE device;
+    int level;
+    int level_max;
+    int level_step;
+    double level_rate;
+    uint64_t bytes_read;
+    //  the order of reading in full scans (auto resolved), the files of the walk to sort
+    int order_mode;
+    int scan_ordered;
+    struct FCD_ELEVATOR elevator;
+    //  rolling verification: the cursor and the slice, the slice is read in this scan
+    struct FCD_ROLLING cover;
+    int scan_rolling;
+    struct FCD_RESULTS results;
+    uint64_t reports_count;
+    sem_t sem_queue;
+    int scan_initial;
+    int scan_deep;
+    int scan_full_pending;
+    int scan_verify;
+    time_t interval_next;
+    void *batch[CRC_BATCH_SIZE];
+    int batch_len;
+    pthread_mutex_t mutex_touched;
+    char **touched_names;
+    size_t touched_count;
+    size_t touched_capacity;
+    //  requests of control.c: the last ticket, taken by a scan, done by its report
+    uint64_t touched_ticket;
+    uint64_t touched_taken;
+    uint64_t touched_done;
+    int touched_verify;
+    int touched_urgent;
+    pthread_cond_t cond_touched;
+    int inotify_fd;
+    int inotify_root_wd;
+    struct FCD_WATCHES watches;
+    //  gauges of the last report, summed over the missions for the metrics
+    int64_t statuses[FCD_RESULT_GONE + 1];
+    //  rolling: bytes verified in the cycle, bytes of the etalon files, the least recent verification
+    int64_t rolling_covered;
+    int64_t rolling_total;
+    int64_t rolling_oldest;
+    pthread_t tid_launcher;
+    pthread_t tid_json_writer;
+};
+
+extern int mission_threads;
+extern long mission_io_rate;
+extern int mission_cpu;
+extern enum FCD_READ_MODE mission_read;
+extern int mission_depth;
+extern long mission_split;
+extern long mission_chunk;
+extern const char *mission_verify_names[];
+extern char* mission_metrics;
+
+extern struct FCD_MISSION *fcd_missions;
+extern sem_t sem_metrics;
+
+void fcd_mission_init(void);
+struct FCD_MISSION *fcd_mission_new(void);
+void fcd_mission_start(struct FCD_MISSION *_mission);
+void fcd_touched_push(struct FCD_MISSION *_mission, const char *_name);
+char **fcd_touched_take(struct FCD_MISSION *_mission, size_t *_count);
+void fcd_touched_free(char **_names, size_t _count);
+uint64_t fcd_touched_request(struct FCD_MISSION *_mission, char **_names, size_t _count, int _full);
+void fcd_touched_wait(struct FCD_MISSION *_mission, uint64_t _ticket);
+void fcd_touched_done(struct FCD_MISSION *_mission);
+void thread_calculators_launcher_inotify_init(struct FCD_MISSION *_mission);
+void thread_calculators_launcher_inotify(void);
+void thread_calculators_launcher_adapt(struct FCD_MISSION *_mission, int64_t _scan_ns);
+void thread_calculators_launcher_settle(struct FCD_MISSION *_mission, int64_t _scan_last);
+int thread_calculators_launcher_initial(struct FCD_MISSION *_mission);
+void thread_calculators_launcher_scan(struct FCD_MISSION *_mission, int _full, char **_names, size_t _count);
+int thread_calculators_launcher_code(struct FCD_FILE *_fcd_file);
+void thread_calculators_launcher_snapshot(struct FCD_MISSION *_mission, struct FCD_RESULT *_result,
+                                          struct FCD_FILE *_fcd_file, int _code);
+void thread_json_writer_record(struct FCD_MISSION *_mission, struct FCD_JSON *_json, struct FCD_REPORT *_report,
+                               struct FCD_RESULT *_result);
+void thread_json_writer_change(struct FCD_MISSION *_mission, struct FCD_JSON *_json, struct FCD_REPORT *_report,
+                               struct FCD_RESULT *_result);
+void thread_json_writer_full(struct FCD_MISSION *_mission, struct FCD_JSON *_json, struct FCD_REPORT *_report);
+_Noreturn void *thread_json_writer_entry_point(void *_arg);
+_Noreturn void *thread_metrics_writer_entry_point(void *_arg);
+
+#endif //FICHEDA_MISSION_H
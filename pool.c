@@ -0,0 +1,202 @@
+/*
+ *  File Check Daemon - пул потоков расчёта
+ *
+ *  Очередь заданий - ограниченная MPMC очередь Вьюкова (bounded MPMC queue):
+ *  у каждой ячейки свой счётчик seq, позиции записи/чтения двигаются CAS.
+ *  Семафоры sem_jobs/sem_space лишь усыпляют потоки, когда очередь
+ *  пуста/заполнена, сама очередь блокировок не использует.
+ *
+ *  поток - Worker
+ *  - жду задание (sem_jobs)
+ *  - забираю задание из очереди, освобождаю место (sem_space)
+ *  - выполняю задание со своим буфером, группа задания - текущая группа потока
+ *  - возвращаю слот группы (sem_slots)
+ *  - уменьшаю счётчик незавершённых заданий группы, на нуле - sem_idle группы
+ *
+ *  Очередь одна на все группы (FIFO), справедливость - за счёт слотов: у каждой
+ *  активной миссии в очереди не больше slots заданий, они чередуются с
+ *  заданиями других миссий, а не ждут за всеми заданиями одной большой миссии.
+ *  Задание, не поданное через try_submit, выполняет сам поток с его слотом, поэтому
+ *  slots - это и число одновременных чтений миссии (уровень под её устройство).
+ */
+#include <errno.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "ficheda.h"
+#include "pool.h"
+#include "reader.h"
+
+static int fcd_pool_enqueue(struct FCD_POOL *_pool, struct FCD_POOL_GROUP *_group, fcd_job_fn _fn, void *_arg) {
+  struct FCD_POOL_CELL *cell;
+  size_t pos = __atomic_load_n(&_pool->enqueue_pos, __ATOMIC_RELAXED);
+  for (;;) {
+    cell = &_pool->cells[pos & _pool->mask];
+    size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+    intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+    if (dif == 0) {
+      if (__atomic_compare_exchange_n(&_pool->enqueue_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+    } else if (dif < 0) {
+      return 0;  //  queue is full
+    } else {
+      pos = __atomic_load_n(&_pool->enqueue_pos, __ATOMIC_RELAXED);
+    }
+  }
+  cell->job.fn = _fn;
+  cell->job.arg = _arg;
+  cell->job.group = _group;
+  __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+  return 1;
+}
+
+static int fcd_pool_dequeue(struct FCD_POOL *_pool, struct FCD_JOB *_job) {
+  struct FCD_POOL_CELL *cell;
+  size_t pos = __atomic_load_n(&_pool->dequeue_pos, __ATOMIC_RELAXED);
+  for (;;) {
+    cell = &_pool->cells[pos & _pool->mask];
+    size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+    intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+    if (dif == 0) {
+      if (__atomic_compare_exchange_n(&_pool->dequeue_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+    } else if (dif < 0) {
+      return 0;  //  queue is empty
+    } else {
+      pos = __atomic_load_n(&_pool->dequeue_pos, __ATOMIC_RELAXED);
+    }
+  }
+  *_job = cell->job;
+  __atomic_store_n(&cell->seq, pos + _pool->mask + 1, __ATOMIC_RELEASE);
+  return 1;
+}
+
+_Noreturn static void *thread_pool_worker_entry_point(void *_arg) {
+  struct FCD_WORKER *worker = _arg;
+  struct FCD_POOL *pool = worker->pool;
+  struct FCD_JOB job;
+  while (1) {
+    //  wait for job
+    while (sem_wait(&pool->sem_jobs))
+      if (errno != EINTR) severe_error_0("sem_wait(sem_jobs)", errno);
+    //  the producer may still be publishing the cell
+    while (!fcd_pool_dequeue(pool, &job)) sched_yield();
+    if (sem_post(&pool->sem_space)) severe_error_0("sem_post(sem_space)", errno);
+    //  do job
+    worker->group = job.group;
+    job.fn(worker, job.arg);
+    if (sem_post(&job.group->sem_slots)) severe_error_0("sem_post(sem_slots)", errno);
+    __atomic_sub_fetch(&pool->pending, 1, __ATOMIC_RELAXED);
+    //  the last job of the group - wake up fcd_pool_wait()
+    if (__atomic_sub_fetch(&job.group->pending, 1, __ATOMIC_ACQ_REL) == 0)
+      if (sem_post(&job.group->sem_idle)) severe_error_0("sem_post(sem_idle)", errno);
+  }
+}
+
+struct FCD_POOL *fcd_pool_create(int _threads, size_t _buff_size) {
+  int cc;
+  struct FCD_POOL *pool = my_malloc(sizeof(struct FCD_POOL));
+  pool->threads = _threads;
+  pool->mask = FCD_POOL_QUEUE - 1;
+  pool->cells = my_malloc(sizeof(struct FCD_POOL_CELL) * FCD_POOL_QUEUE);
+  for (size_t i = 0; i < FCD_POOL_QUEUE; ++i) pool->cells[i].seq = i;
+  pool->enqueue_pos = pool->dequeue_pos = 0;
+  pool->pending = 0;
+  if (sem_init(&pool->sem_jobs, 0, 0)) severe_error_0("sem_init(sem_jobs)", errno);
+  if (sem_init(&pool->sem_space, 0, FCD_POOL_QUEUE)) severe_error_0("sem_init(sem_space)", errno);
+  pool->workers = my_malloc(sizeof(struct FCD_WORKER) * _threads);
+  for (int i = 0; i < _threads; ++i) {
+    struct FCD_WORKER *worker = &pool->workers[i];
+    worker->id = i;
+    worker->pool = pool;
+    worker->group = NULL;
+    worker->buff_size = _buff_size;
+    //  aligned for O_DIRECT reads
+    cc = posix_memalign((void **)&worker->buff, FCD_READ_ALIGN, _buff_size);
+    if (cc != 0) severe_error_0("posix_memalign(worker)", cc);
+    cc = pthread_create(&worker->thread, NULL, &thread_pool_worker_entry_point, worker);
+    if (cc != 0) severe_error_0("pthread_create(worker)", cc);
+  }
+  return pool;
+}
+
+/*
+ * void fcd_pool_group_init( struct FCD_POOL_GROUP *group, int slots, void *owner );
+ *
+ * The function fcd_pool_group_init() prepares a group of jobs: at most slots
+ * jobs of the group are queued or running at once. A job finds the owner of
+ * its group (a mission) through the worker: _worker->group->owner.
+ */
+void fcd_pool_group_init(struct FCD_POOL_GROUP *_group, int _slots, void *_owner) {
+  _group->pending = 0;
+  _group->slots = _slots;
+  _group->owner = _owner;
+  if (sem_init(&_group->sem_idle, 0, 0)) severe_error_0("sem_init(sem_idle)", errno);
+  if (sem_init(&_group->sem_slots, 0, _slots)) severe_error_0("sem_init(sem_slots)", errno);
+}
+
+/*
+ * void fcd_pool_group_resize( struct FCD_POOL_GROUP *group, int slots );
+ *
+ * The function fcd_pool_group_resize() changes the number of jobs of the group
+ * at once. A smaller share waits for the jobs in the way to return their slots;
+ * only the submitter of the group may call it (never a job of the group).
+ */
+void fcd_pool_group_resize(struct FCD_POOL_GROUP *_group, int _slots) {
+  for (; _group->slots < _slots; ++_group->slots)
+    if (sem_post(&_group->sem_slots)) severe_error_0("sem_post(sem_slots)", errno);
+  for (; _group->slots > _slots; --_group->slots)
+    while (sem_wait(&_group->sem_slots))
+      if (errno != EINTR) severe_error_0("sem_wait(sem_slots)", errno);
+}
+
+void fcd_pool_submit(struct FCD_POOL *_pool, struct FCD_POOL_GROUP *_group, fcd_job_fn _fn, void *_arg) {
+  fcd_pool_submit_batch(_pool, _group, _fn, &_arg, 1);
+}
+
+void fcd_pool_submit_batch(struct FCD_POOL *_pool, struct FCD_POOL_GROUP *_group, fcd_job_fn _fn, void **_args, int _n) {
+  if (_n <= 0) return;
+  __atomic_add_fetch(&_group->pending, _n, __ATOMIC_ACQ_REL);
+  __atomic_add_fetch(&_pool->pending, _n, __ATOMIC_RELAXED);
+  for (int i = 0; i < _n; ++i) {
+    //  wait for the share of the group, then for free cell
+    while (sem_wait(&_group->sem_slots))
+      if (errno != EINTR) severe_error_0("sem_wait(sem_slots)", errno);
+    while (sem_wait(&_pool->sem_space))
+      if (errno != EINTR) severe_error_0("sem_wait(sem_space)", errno);
+    //  a consumer may still be releasing the cell
+    while (!fcd_pool_enqueue(_pool, _group, _fn, _args[i])) sched_yield();
+    if (sem_post(&_pool->sem_jobs)) severe_error_0("sem_post(sem_jobs)", errno);
+  }
+}
+
+//  never blocks: 0 - the queue is full or the group used its share (a worker may call it without deadlock)
+int fcd_pool_try_submit(struct FCD_POOL *_pool, struct FCD_POOL_GROUP *_group, fcd_job_fn _fn, void *_arg) {
+  if (sem_trywait(&_group->sem_slots)) return 0;
+  if (sem_trywait(&_pool->sem_space)) {
+    if (sem_post(&_group->sem_slots)) severe_error_0("sem_post(sem_slots)", errno);
+    return 0;
+  }
+  __atomic_add_fetch(&_group->pending, 1, __ATOMIC_ACQ_REL);
+  __atomic_add_fetch(&_pool->pending, 1, __ATOMIC_RELAXED);
+  while (!fcd_pool_enqueue(_pool, _group, _fn, _arg)) sched_yield();
+  if (sem_post(&_pool->sem_jobs)) severe_error_0("sem_post(sem_jobs)", errno);
+  return 1;
+}
+
+void fcd_pool_wait(struct FCD_POOL_GROUP *_group) {
+  //  sem_idle may hold stale posts from earlier batches - recheck the counter
+  while (__atomic_load_n(&_group->pending, __ATOMIC_ACQUIRE) != 0)
+    if (sem_wait(&_group->sem_idle) && errno != EINTR) severe_error_0("sem_wait(sem_idle)", errno);
+}
+
+//  jobs in the queue, not taken by workers yet (metrics, a racy snapshot)
+size_t fcd_pool_depth(struct FCD_POOL *_pool) {
+  size_t dequeue_pos = __atomic_load_n(&_pool->dequeue_pos, __ATOMIC_RELAXED);
+  size_t enqueue_pos = __atomic_load_n(&_pool->enqueue_pos, __ATOMIC_RELAXED);
+  return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+}
+
+long fcd_pool_pending(struct FCD_POOL *_pool) {
+  return __atomic_load_n(&_pool->pending, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,78 @@
+/*
+ *  File Check Daemon - пул потоков расчёта
+ *
+ *  - фиксированное число долгоживущих потоков (workers)
+ *  - у каждого потока свой буфер чтения, выделяется один раз
+ *  - задания поступают через ограниченную lock-free MPMC очередь
+ *  - задание принадлежит группе (миссии): fcd_pool_wait() ждёт завершения всех
+ *    заданий своей группы, задания из потоков пула наследуют группу текущего
+ *  - у группы ограничено число заданий в обороте (slots) - очередь не занята
+ *    одной миссией, задания миссий чередуются (справедливая доля потоков)
+ *  - fcd_pool_try_submit() не ждёт места в очереди и слота - для заданий из потоков пула
+ *  - fcd_pool_group_resize() меняет число слотов группы на ходу (подстройка под устройство)
+ */
+#ifndef FICHEDA_POOL_H
+#define FICHEDA_POOL_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stddef.h>
+
+#define FCD_POOL_QUEUE    4096
+#define FCD_CACHE_LINE    64
+
+struct FCD_POOL;
+
+struct FCD_POOL_GROUP {
+    long pending __attribute__((aligned(FCD_CACHE_LINE)));
+    sem_t sem_idle;
+    sem_t sem_slots;
+    int slots;
+    void *owner;
+};
+
+struct FCD_WORKER {
+    int id;
+    unsigned char *buff;
+    size_t buff_size;
+    pthread_t thread;
+    struct FCD_POOL *pool;
+    struct FCD_POOL_GROUP *group;
+};
+
+typedef void (*fcd_job_fn)(struct FCD_WORKER *_worker, void *_arg);
+
+struct FCD_JOB {
+    fcd_job_fn fn;
+    void *arg;
+    struct FCD_POOL_GROUP *group;
+};
+
+struct FCD_POOL_CELL {
+    size_t seq;
+    struct FCD_JOB job;
+};
+
+struct FCD_POOL {
+    size_t enqueue_pos __attribute__((aligned(FCD_CACHE_LINE)));
+    size_t dequeue_pos __attribute__((aligned(FCD_CACHE_LINE)));
+    long pending __attribute__((aligned(FCD_CACHE_LINE)));
+    struct FCD_POOL_CELL *cells;
+    size_t mask;
+    sem_t sem_jobs;
+    sem_t sem_space;
+    int threads;
+    struct FCD_WORKER *workers;
+};
+
+struct FCD_POOL *fcd_pool_create(int _threads, size_t _buff_size);
+void fcd_pool_group_init(struct FCD_POOL_GROUP *_group, int _slots, void *_owner);
+void fcd_pool_group_resize(struct FCD_POOL_GROUP *_group, int _slots);
+void fcd_pool_submit(struct FCD_POOL *_pool, struct FCD_POOL_GROUP *_group, fcd_job_fn _fn, void *_arg);
+void fcd_pool_submit_batch(struct FCD_POOL *_pool, struct FCD_POOL_GROUP *_group, fcd_job_fn _fn, void **_args, int _n);
+int fcd_pool_try_submit(struct FCD_POOL *_pool, struct FCD_POOL_GROUP *_group, fcd_job_fn _fn, void *_arg);
+void fcd_pool_wait(struct FCD_POOL_GROUP *_group);
+size_t fcd_pool_depth(struct FCD_POOL *_pool);
+long fcd_pool_pending(struct FCD_POOL *_pool);
+
+#endif //FICHEDA_POOL_H
@@ -0,0 +1,284 @@
+/*
+ *  File Check Daemon - движки чтения файла для расчёта
+ *
+ *  Файл, укороченный во время расчёта из mmap(), даёт SIGBUS. Обработчик
+ *  возвращает поток в fcd_read_mmap() через siglongjmp(), расчёт файла
+ *  завершается ошибкой EIO, демон продолжает работу.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "budget.h"
+#include "ficheda.h"
+#include "reader.h"
+#include "uring.h"
+
+const char *fcd_read_mode_names[FCD_READ_MODES] = {"buffered", "mmap", "direct", "uring"};
+
+static struct FCD_READ_STATS fcd_read_stats[FCD_READ_MODES];
+static __thread sigjmp_buf *fcd_read_sigbus_jmp = NULL;
+static int fcd_read_uring_depth = FCD_URING_DEPTH;
+//  io_uring of the pool thread: 0 - not created yet, 1 - ready, -1 - not available
+static __thread int fcd_read_ring_state = 0;
+static __thread struct FCD_URING fcd_read_ring;
+static __thread unsigned char *fcd_read_ring_buff = NULL;
+
+static void fcd_read_sigbus(int _signum, siginfo_t *_info, void *_context) {
+  if (fcd_read_sigbus_jmp) siglongjmp(*fcd_read_sigbus_jmp, 1);
+  //  not our mapping - default action
+  signal(SIGBUS, SIG_DFL);
+  raise(SIGBUS);
+}
+
+void fcd_read_init(int _uring_depth) {
+  struct sigaction sa;
+  if (_uring_depth > 0) fcd_read_uring_depth = _uring_depth;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = fcd_read_sigbus;
+  sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+  sigemptyset(&sa.sa_mask);
+  if (sigaction(SIGBUS, &sa, NULL)) severe_error_0("sigaction(SIGBUS)", errno);
+}
+
+int fcd_read_mode(const char *_name) {
+  for (int mode = 0; mode < FCD_READ_MODES; ++mode)
+    if (strcmp(fcd_read_mode_names[mode], _name) == 0) return mode;
+  return -1;
+}
+
+static ssize_t fcd_read_pread(int _fd, void *_buf, size_t _len, off_t _pos) {
+  ssize_t rl;
+  while ((rl = pread(_fd, _buf, _len, _pos)) < 0 && errno == EINTR);
+  return rl;
+}
+
+static int fcd_read_buffered(struct FCD_READ *_read, uint64_t *_bytes) {
+  off_t pos = _read->offset;
+  off_t end = _read->length < 0 ? -1 : _read->offset + _read->length;
+  posix_fadvise(_read->fd, _read->offset, _read->length < 0 ? 0 : _read->length, POSIX_FADV_SEQUENTIAL);
+  while (end < 0 || pos < end) {
+    size_t want = _read->buff_size;
+    if (end >= 0 && (off_t)want > end - pos) want = end - pos;
+    ssize_t rl = fcd_read_pread(_read->fd, _read->buff, want, pos);
+    if (rl < 0) {
+      _read->errop = "pread";
+      return errno;
+    }
+    if (rl == 0) break;
+    _read->consume(_read->ctx, _read->buff, rl);
+    //  the page cache is not ours - give it back
+    posix_fadvise(_read->fd, pos, rl, POSIX_FADV_DONTNEED);
+    pos += rl;
+    *_bytes += rl;
+  }
+  return 0;
+}
+
+static int fcd_read_mmap(struct FCD_READ *_read, uint64_t *_bytes) {
+  sigjmp_buf jmp;
+  long page = sysconf(_SC_PAGESIZE);
+  off_t end = _read->length < 0 ? _read->size : _read->offset + _read->length;
+  //  pages past EOF raise SIGBUS
+  if (end > _read->size) end = _read->size;
+  //  changed after sigsetjmp() - volatile, not clobbered by siglongjmp()
+  volatile off_t pos = _read->offset;
+  volatile unsigned char *map = NULL;
+  volatile size_t map_len = 0;
+  if (sigsetjmp(jmp, 1)) {
+    //  SIGBUS - the file was truncated under the mapping
+    fcd_read_sigbus_jmp = NULL;
+    if (map) munmap((void *)map, map_len);
+    _read->errop = "mmap";
+    return EIO;
+  }
+  while (pos < end) {
+    off_t base = pos & ~((off_t)page - 1);
+    size_t skip = pos - base;
+    map_len = FCD_MMAP_WINDOW;
+    if ((off_t)(map_len - skip) > end - pos) map_len = skip + (end - pos);
+    map = mmap(NULL, map_len, PROT_READ, MAP_SHARED, _read->fd, base);
+    if (map == MAP_FAILED) {
+      map = NULL;
+      _read->errop = "mmap";
+      return errno;
+    }
+    madvise((void *)map, map_len, MADV_SEQUENTIAL);
+    fcd_read_sigbus_jmp = &jmp;
+    //  hash straight from the mapping, block by block (budgets are per block)
+    for (size_t i = skip; i < map_len; i += _read->buff_size) {
+      size_t len = map_len - i < _read->buff_size ? map_len - i : _read->buff_size;
+      _read->consume(_read->ctx, (const unsigned char *)map + i, len);
+    }
+    fcd_read_sigbus_jmp = NULL;
+    munmap((void *)map, map_len);
+    map = NULL;
+    posix_fadvise(_read->fd, base, map_len, POSIX_FADV_DONTNEED);
+    *_bytes += map_len - skip;
+    pos = base + map_len;
+  }
+  return 0;
+}
+
+static int fcd_read_direct(struct FCD_READ *_read, uint64_t *_bytes) {
+  int flags = fcntl(_read->fd, F_GETFL);
+  if (flags < 0 || fcntl(_read->fd, F_SETFL, flags | O_DIRECT)) return -1;
+  off_t end = _read->length < 0 ? -1 : _read->offset + _read->length;
+  off_t pos = _read->offset & ~((off_t)FCD_READ_ALIGN - 1);
+  size_t skip = _read->offset - pos;
+  while (end < 0 || pos < end) {
+    ssize_t rl = fcd_read_pread(_read->fd, _read->buff, _read->buff_size, pos);
+    if (rl < 0) {
+      int cc = errno;
+      fcntl(_read->fd, F_SETFL, flags);
+      //  the file system refused O_DIRECT - buffered read
+      if (cc == EINVAL && *_bytes == 0) return -1;
+      _read->errop = "pread";
+      return cc;
+    }
+    if ((size_t)rl <= skip) break;
+    size_t len = rl - skip;
+    if (end >= 0 && (off_t)len > end - pos - (off_t)skip) len = end - pos - skip;
+    _read->consume(_read->ctx, _read->buff + skip, len);
+    *_bytes += len;
+    pos += rl;
+    skip = 0;
+    if ((size_t)rl < _read->buff_size) break;
+  }
+  fcntl(_read->fd, F_SETFL, flags);
+  return 0;
+}
+
+int fcd_read_uring_probe(void) {
+  struct FCD_URING ring;
+  if (fcd_uring_init(&ring, 1)) return 0;
+  fcd_uring_free(&ring);
+  return 1;
+}
+
+//  the ring lives as long as the pool thread, buffers are registered once
+static int fcd_read_uring_ring(struct FCD_READ *_read, int _slots, size_t _slot_size) {
+  if (fcd_read_ring_state == 0) {
+    fcd_read_ring_state = fcd_uring_init(&fcd_read_ring, _slots) ? -1 : 1;
+  }
+  if (fcd_read_ring_state < 0) return 0;
+  if (fcd_read_ring_buff != _read->buff) {
+    struct iovec iov[_slots];
+    if (fcd_read_ring_buff) fcd_uring_unregister(&fcd_read_ring);
+    for (int i = 0; i < _slots; ++i) {
+      iov[i].iov_base = _read->buff + i * _slot_size;
+      iov[i].iov_len = _slot_size;
+    }
+    //  RLIMIT_MEMLOCK may forbid pinning - plain IORING_OP_READ then
+    fcd_read_ring_buff = fcd_uring_register(&fcd_read_ring, iov, _slots) ? NULL : _read->buff;
+  }
+  return 1;
+}
+
+static int fcd_read_uring(struct FCD_READ *_read, uint64_t *_bytes) {
+  int slots = fcd_read_uring_depth;
+  size_t slot_size = (_read->buff_size / slots) & ~((size_t)FCD_READ_ALIGN - 1);
+  if (slot_size < FCD_READ_ALIGN) {
+    slot_size = FCD_READ_ALIGN;
+    slots = _read->buff_size / FCD_READ_ALIGN;
+  }
+  if (!fcd_read_uring_ring(_read, slots, slot_size)) return -1;
+  int fixed = fcd_read_ring_buff != NULL;
+  off_t end = _read->length < 0 ? _read->size : _read->offset + _read->length;
+  off_t next = _read->offset;
+  int res[slots], done[slots];
+  size_t len[slots];
+  int head = 0, tail = 0, inflight = 0, cc = 0, eof = 0;
+  uint64_t slot;
+  while (1) {
+    //  keep all slots in flight
+    while (!cc && !eof && inflight < slots && next < end) {
+      len[tail] = end - next < (off_t)slot_size ? (size_t)(end - next) : slot_size;
+      done[tail] = 0;
+      cc = fcd_uring_read(&fcd_read_ring, _read->fd, _read->buff + tail * slot_size, len[tail], next,
+                          fixed ? tail : -1, tail);
+      if (cc) {
+        _read->errop = "io_uring_sqe";
+        break;
+      }
+      next += len[tail];
+      tail = (tail + 1) % slots;
+      ++inflight;
+    }
+    if (!inflight) break;
+    int rc, rl;
+    rc = fcd_uring_wait(&fcd_read_ring, &slot, &rl);
+    if (rc) {
+      //  the ring is broken - the kernel may still write to the buffers, do not reuse it
+      fcd_read_ring_state = -1;
+      _read->errop = "io_uring_enter";
+      return rc;
+    }
+    res[slot] = rl;
+    done[slot] = 1;
+    //  hash the completed slots in file order
+    while (inflight && done[head]) {
+      if (res[head] < 0) {
+        if (!cc) {
+          cc = -res[head];
+          _read->errop = "io_uring_read";
+        }
+      } else if (!cc && !eof) {
+        _read->consume(_read->ctx, _read->buff + head * slot_size, res[head]);
+        *_bytes += res[head];
+        //  short read - end of file
+        if ((size_t)res[head] < len[head]) eof = 1;
+      }
+      done[head] = 0;
+      head = (head + 1) % slots;
+      --inflight;
+    }
+  }
+  return cc;
+}
+
+/*
+ * int fcd_read( enum FCD_READ_MODE mode, struct FCD_READ *read );
+ *
+ * The function fcd_read() passes the range of the file to read->consume()
+ * in order. Returns 0 or errno (read->errop - the failed operation).
+ */
+int fcd_read(enum FCD_READ_MODE _mode, struct FCD_READ *_read) {
+  int cc;
+  uint64_t bytes = 0;
+  int64_t ns = fcd_clock_ns(CLOCK_MONOTONIC);
+  switch (_mode) {
+    case FCD_READ_MMAP:
+      cc = fcd_read_mmap(_read, &bytes);
+      break;
+    case FCD_READ_DIRECT:
+      cc = fcd_read_direct(_read, &bytes);
+      break;
+    case FCD_READ_URING:
+      cc = fcd_read_uring(_read, &bytes);
+      break;
+    default:
+      cc = -1;
+      break;
+  }
+  //  the engine is not available - buffered read
+  if (cc < 0) {
+    _mode = FCD_READ_BUFFERED;
+    cc = fcd_read_buffered(_read, &bytes);
+  }
+  ns = fcd_clock_ns(CLOCK_MONOTONIC) - ns;
+  __atomic_add_fetch(&fcd_read_stats[_mode].files, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&fcd_read_stats[_mode].bytes, bytes, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&fcd_read_stats[_mode].ns, ns, __ATOMIC_RELAXED);
+  return cc;
+}
+
+void fcd_read_stats_take(enum FCD_READ_MODE _mode, struct FCD_READ_STATS *_stats) {
+  _stats->files = __atomic_exchange_n(&fcd_read_stats[_mode].files, 0, __ATOMIC_RELAXED);
+  _stats->bytes = __atomic_exchange_n(&fcd_read_stats[_mode].bytes, 0, __ATOMIC_RELAXED);
+  _stats->ns = __atomic_exchange_n(&fcd_read_stats[_mode].ns, 0, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,53 @@
+/*
+ *  File Check Daemon - движки чтения файла для расчёта
+ *
+ *  Движок читает диапазон [offset, offset+length) открытого файла и отдаёт
+ *  его по порядку блоками в consume(). Режимы:
+ *  - buffered - pread() + posix_fadvise(SEQUENTIAL), DONTNEED после блока
+ *  - mmap     - окна mmap() + MADV_SEQUENTIAL, расчёт прямо из отображения
+ *  - direct   - O_DIRECT в выровненный буфер потока (если ФС не умеет - buffered)
+ *  - uring    - io_uring: буфер потока делится на depth слотов, все слоты в чтении
+ *               одновременно, CRC по порядку по мере завершения (нет io_uring - buffered)
+ */
+#ifndef FICHEDA_READER_H
+#define FICHEDA_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define FCD_READ_ALIGN        4096
+#define FCD_MMAP_WINDOW       (64 * 1048576)
+#define FCD_URING_DEPTH       16
+
+enum FCD_READ_MODE {FCD_READ_BUFFERED, FCD_READ_MMAP, FCD_READ_DIRECT, FCD_READ_URING, FCD_READ_MODES};
+
+typedef void (*fcd_consume_fn)(void *_ctx, const unsigned char *_buf, size_t _len);
+
+struct FCD_READ {
+    int fd;
+    off_t size;
+    off_t offset;
+    off_t length;
+    unsigned char *buff;
+    size_t buff_size;
+    fcd_consume_fn consume;
+    void *ctx;
+    const char *errop;
+};
+
+struct FCD_READ_STATS {
+    uint64_t files;
+    uint64_t bytes;
+    uint64_t ns;
+};
+
+extern const char *fcd_read_mode_names[FCD_READ_MODES];
+
+void fcd_read_init(int _uring_depth);
+int fcd_read_uring_probe(void);
+int fcd_read_mode(const char *_name);
+int fcd_read(enum FCD_READ_MODE _mode, struct FCD_READ *_read);
+void fcd_read_stats_take(enum FCD_READ_MODE _mode, struct FCD_READ_STATS *_stats);
+
+#endif //FICHEDA_READER_H
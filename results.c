@@ -0,0 +1,146 @@
+/*
+ *  File Check Daemon - отчёты для JSON-writer
+ *
+ *  Очередь готовых отчётов - та же схема, что у очереди пула (seq у каждой
+ *  ячейки), но потребитель один: позиция чтения двигается без CAS. Семафор
+ *  sem_items используется, только когда потребитель уснул. Отчётов в обороте
+ *  не больше, чем буферов (sem_free), поэтому очередь не переполняется.
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ficheda.h"
+#include "results.h"
+
+void fcd_results_init(struct FCD_RESULTS *_results, int _reports) {
+  _results->mask = FCD_RESULTS_QUEUE - 1;
+  _results->cells = my_malloc(sizeof(struct FCD_RESULTS_CELL) * FCD_RESULTS_QUEUE);
+  for (size_t i = 0; i < FCD_RESULTS_QUEUE; ++i) _results->cells[i].seq = i;
+  _results->enqueue_pos = _results->dequeue_pos = 0;
+  _results->sleeping = 0;
+  _results->reports_seq = 0;
+  if (sem_init(&_results->sem_items, 0, 0)) severe_error_0("sem_init(sem_items)", errno);
+  if (_reports > FCD_RESULTS_QUEUE) _reports = FCD_RESULTS_QUEUE;
+  //  report buffers grow with the list on demand
+  _results->free = NULL;
+  for (int i = 0; i < _reports; ++i) {
+    struct FCD_REPORT *report = my_malloc(sizeof(struct FCD_REPORT));
+    report->records = NULL;
+    report->count = report->capacity = 0;
+    report->ranges = NULL;
+    report->ranges_count = report->ranges_capacity = 0;
+    report->next = _results->free;
+    _results->free = report;
+  }
+  if (pthread_mutex_init(&_results->mutex_free, NULL)) severe_error_0("pthread_mutex_init(mutex_free)", errno);
+  if (sem_init(&_results->sem_free, 0, _reports)) severe_error_0("sem_init(sem_free)", errno);
+}
+
+/*
+ * struct FCD_REPORT *fcd_results_open( struct FCD_RESULTS *results, size_t count );
+ *
+ * The function fcd_results_open() returns an empty report buffer with room
+ * for count records, waits if all buffers are pending in the JSON-writer.
+ */
+struct FCD_REPORT *fcd_results_open(struct FCD_RESULTS *_results, size_t _count) {
+  struct FCD_REPORT *report;
+  while (sem_wait(&_results->sem_free))
+    if (errno != EINTR) severe_error_0("sem_wait(sem_free)", errno);
+  //  lock mutex
+  if (pthread_mutex_lock(&_results->mutex_free)) severe_error_0("pthread_mutex_lock(mutex_free)", errno);
+  report = _results->free;
+  _results->free = report->next;
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_results->mutex_free)) severe_error_0("pthread_mutex_unlock(mutex_free)", errno);
+  if (report->capacity < _count) {
+    free(report->records);
+    report->capacity = _count + _count / 4;
+    report->records = my_malloc(sizeof(struct FCD_RESULT) * report->capacity);
+  }
+  report->count = 0;
+  report->ranges_count = 0;
+  return report;
+}
+
+//  the next range of the report (the array grows, records keep indexes)
+struct FCD_RANGE *fcd_results_range(struct FCD_REPORT *_report) {
+  if (_report->ranges_count == _report->ranges_capacity) {
+    size_t capacity = _report->ranges_capacity ? _report->ranges_capacity * 2 : 64;
+    struct FCD_RANGE *ranges = my_malloc(sizeof(struct FCD_RANGE) * capacity);
+    if (_report->ranges_count) memcpy(ranges, _report->ranges, sizeof(struct FCD_RANGE) * _report->ranges_count);
+    free(_report->ranges);
+    _report->ranges = ranges;
+    _report->ranges_capacity = capacity;
+  }
+  return &_report->ranges[_report->ranges_count++];
+}
+
+void fcd_results_push(struct FCD_RESULTS *_results, struct FCD_REPORT *_report) {
+  struct FCD_RESULTS_CELL *cell;
+  size_t pos = __atomic_load_n(&_results->enqueue_pos, __ATOMIC_RELAXED);
+  for (;;) {
+    cell = &_results->cells[pos & _results->mask];
+    size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+    if (seq == pos) {
+      if (__atomic_compare_exchange_n(&_results->enqueue_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+    } else {
+      pos = __atomic_load_n(&_results->enqueue_pos, __ATOMIC_RELAXED);
+    }
+  }
+  _report->seq = ++_results->reports_seq;
+  cell->report = _report;
+  __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+  //  wake up the writer only if it sleeps
+  if (__atomic_exchange_n(&_results->sleeping, 0, __ATOMIC_SEQ_CST))
+    if (sem_post(&_results->sem_items)) severe_error_0("sem_post(sem_items)", errno);
+}
+
+static struct FCD_REPORT *fcd_results_drain(struct FCD_RESULTS *_results) {
+  size_t pos = _results->dequeue_pos;
+  struct FCD_RESULTS_CELL *cell = &_results->cells[pos & _results->mask];
+  if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != pos + 1) return NULL;
+  struct FCD_REPORT *report = cell->report;
+  __atomic_store_n(&cell->seq, pos + _results->mask + 1, __ATOMIC_RELEASE);
+  _results->dequeue_pos = pos + 1;
+  return report;
+}
+
+/*
+ * struct FCD_REPORT *fcd_results_take( struct FCD_RESULTS *results );
+ *
+ * The function fcd_results_take() returns the oldest pending report, waits
+ * if there is none. The report goes back with fcd_results_release().
+ */
+struct FCD_REPORT *fcd_results_take(struct FCD_RESULTS *_results) {
+  struct FCD_REPORT *report;
+  while (!(report = fcd_results_drain(_results))) {
+    __atomic_store_n(&_results->sleeping, 1, __ATOMIC_SEQ_CST);
+    //  a report published before the flag was set is not followed by sem_post
+    if ((report = fcd_results_drain(_results))) {
+      __atomic_store_n(&_results->sleeping, 0, __ATOMIC_RELAXED);
+      break;
+    }
+    while (sem_wait(&_results->sem_items))
+      if (errno != EINTR) severe_error_0("sem_wait(sem_items)", errno);
+  }
+  return report;
+}
+
+void fcd_results_release(struct FCD_RESULTS *_results, struct FCD_REPORT *_report) {
+  //  lock mutex
+  if (pthread_mutex_lock(&_results->mutex_free)) severe_error_0("pthread_mutex_lock(mutex_free)", errno);
+  _report->next = _results->free;
+  _results->free = _report;
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_results->mutex_free)) severe_error_0("pthread_mutex_unlock(mutex_free)", errno);
+  if (sem_post(&_results->sem_free)) severe_error_0("sem_post(sem_free)", errno);
+}
+
+//  reports pushed and not taken by JSON-writer yet (metrics, a racy snapshot)
+size_t fcd_results_pending(struct FCD_RESULTS *_results) {
+  size_t dequeue_pos = __atomic_load_n(&_results->dequeue_pos, __ATOMIC_RELAXED);
+  size_t enqueue_pos = __atomic_load_n(&_results->enqueue_pos, __ATOMIC_RELAXED);
+  return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+}
@@ -0,0 +1,102 @@
+/*
+ *  File Check Daemon - отчёты для JSON-writer
+ *
+ *  - отчёт - буфер снимков состояния файлов списка на момент конца сканирования:
+ *    контрольные суммы, источник, код ошибки копируются в запись, следующее сканирование
+ *    их уже не меняет (имена не копируются - они не освобождаются)
+ *  - буферов отчётов reports, создаются заранее и переиспользуются; свободного
+ *    нет - Calculators-Launcher ждёт, пока JSON-writer допишет старый отчёт
+ *  - у FAIL файлов с суммами блоков - диапазоны изменений, снимок в общем массиве
+ *    отчёта ranges (запись хранит начало и число своих диапазонов)
+ *  - со скользящей проверкой (rolling) - ход цикла в отчёте, время проверки файла целиком в записи
+ *  - полный отчёт - все файлы списка, иначе только файлы со сменой статуса
+ *    (для журнала изменений), в записи и прошлый статус (from)
+ *  - готовые отчёты - ограниченная lock-free очередь, JSON-writer пишет их
+ *    строго по порядку
+ *  - потребитель спит на семафоре, только если очередь пуста (флаг sleeping)
+ */
+#ifndef FICHEDA_RESULTS_H
+#define FICHEDA_RESULTS_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "etalon.h"
+#include "pool.h"
+#include "rolling.h"
+
+#define FCD_RESULTS_QUEUE     64
+#define FCD_RESULTS_REPORTS   2
+
+//  record codes: digest matches, read error, deleted file, file not from the etalon,
+//  digest differs, file not from the etalon is deleted too; 0 - not reported yet
+#define FCD_RESULT_OK         1
+#define FCD_RESULT_ERR        2
+#define FCD_RESULT_DEL        3
+#define FCD_RESULT_NEW        4
+#define FCD_RESULT_FAIL       5
+#define FCD_RESULT_GONE       6
+
+//  bytes [start, end) of a FAIL file: changed blocks or blocks skipped by early verification
+struct FCD_RANGE {
+    uint64_t start, end;
+    int unverified;
+};
+
+struct FCD_RESULT {
+    const char *name;
+    unsigned char digest_original[FCD_DIGEST_MAX], digest_next[FCD_DIGEST_MAX];
+    int errnum;
+    unsigned char code;
+    unsigned char from;
+    unsigned char source;
+    unsigned char partial;
+    uint32_t verified;
+    size_t ranges_first;
+    size_t ranges_count;
+};
+
+struct FCD_REPORT {
+    struct FCD_REPORT *next;
+    uint64_t seq;
+    int64_t time_ns;
+    int full;
+    //  rolling verification - the progress of the cycle, the time of verification in the records
+    int rolling;
+    struct FCD_COVERAGE coverage;
+    size_t count;
+    size_t capacity;
+    struct FCD_RESULT *records;
+    size_t ranges_count;
+    size_t ranges_capacity;
+    struct FCD_RANGE *ranges;
+};
+
+struct FCD_RESULTS_CELL {
+    size_t seq;
+    struct FCD_REPORT *report;
+};
+
+struct FCD_RESULTS {
+    size_t enqueue_pos __attribute__((aligned(FCD_CACHE_LINE)));
+    size_t dequeue_pos __attribute__((aligned(FCD_CACHE_LINE)));
+    int sleeping __attribute__((aligned(FCD_CACHE_LINE)));
+    struct FCD_RESULTS_CELL *cells;
+    size_t mask;
+    sem_t sem_items;
+    uint64_t reports_seq;
+    pthread_mutex_t mutex_free;
+    struct FCD_REPORT *free;
+    sem_t sem_free;
+};
+
+void fcd_results_init(struct FCD_RESULTS *_results, int _reports);
+struct FCD_REPORT *fcd_results_open(struct FCD_RESULTS *_results, size_t _count);
+struct FCD_RANGE *fcd_results_range(struct FCD_REPORT *_report);
+void fcd_results_push(struct FCD_RESULTS *_results, struct FCD_REPORT *_report);
+struct FCD_REPORT *fcd_results_take(struct FCD_RESULTS *_results);
+void fcd_results_release(struct FCD_RESULTS *_results, struct FCD_REPORT *_report);
+size_t fcd_results_pending(struct FCD_RESULTS *_results);
+
+#endif //FICHEDA_RESULTS_H
@@ -0,0 +1,258 @@
+/*
+ *  File Check Daemon - скользящая выборочная проверка (rolling)
+ *
+ *  Файл etalon.rolling (порядок байт - машинный): заголовок FCD_ROLLING_HEADER
+ *  (сигнатура, версия, CRC-32 всего остального, подпись файла etalon, курсор и ход
+ *  цикла), потом count времён проверки uint32_t по номерам записей. Записывается во
+ *  временный файл рядом и переименовывается поверх (rename()).
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "crc32.h"
+#include "ficheda.h"
+#include "rolling.h"
+
+//  a file with the block digests of the etalon - the slice may cut it at a block boundary
+static int fcd_rolling_blocks(struct FCD_FILE *_fcd_file, uint64_t _chunk) {
+  uint64_t size = _fcd_file->sig.size;
+  return _fcd_file->blocks && size > _chunk && _fcd_file->blocks->original_count == (size + _chunk - 1) / _chunk;
+}
+
+/*
+ * int fcd_rolling_slice( struct FCD_ROLLING *rolling, struct FCD_ETALON *etalon, uint64_t budget, int cycle,
+ *                        uint64_t chunk, int64_t now );
+ *
+ * The function fcd_rolling_slice() takes the next slice of the etalon files
+ * (OLD) from the cursor: budget bytes, at least 1/cycle of all of them (cycle
+ * 0 - budget only). A cursor at the end of the list starts a new cycle.
+ * Returns 1 - the slice ends the cycle.
+ */
+int fcd_rolling_slice(struct FCD_ROLLING *_rolling, struct FCD_ETALON *_etalon, uint64_t _budget, int _cycle,
+                      uint64_t _chunk, int64_t _now) {
+  struct FCD_COVERAGE *coverage = &_rolling->coverage;
+  struct FCD_FILE *fcd_file;
+  uint64_t total = 0, left, rest;
+  size_t n;
+  for (n = 0; n < _etalon->count; ++n) {
+    fcd_file = fcd_etalon_file(_etalon, n);
+    if (fcd_file->state == FCD_STATE_OLD) total += fcd_file->sig.size;
+  }
+  coverage->total = total;
+  if (_cycle && (total + _cycle - 1) / _cycle > _budget) _budget = (total + _cycle - 1) / _cycle;
+  if (!coverage->cycle || _rolling->cursor >= _etalon->count) {
+    ++coverage->cycle;
+    coverage->intervals = 0;
+    coverage->covered = 0;
+    coverage->cycle_start = _now;
+    _rolling->cursor = 0;
+    _rolling->offset = 0;
+  }
+  ++coverage->intervals;
+  _rolling->start_index = _rolling->cursor;
+  _rolling->start_offset = _rolling->offset;
+  _rolling->start_since = _rolling->offset ? _rolling->since : _now;
+  left = _budget;
+  for (n = _rolling->cursor; n < _etalon->count; ++n, _rolling->offset = 0) {
+    fcd_file = fcd_etalon_file(_etalon, n);
+    //  deleted, new or unreadable - not of the etalon to sample
+    if (fcd_file->state != FCD_STATE_OLD) continue;
+    rest = (uint64_t)fcd_file->sig.size > _rolling->offset ? fcd_file->sig.size - _rolling->offset : 0;
+    if (rest > left) {
+      if (!left) break;
+      if (fcd_rolling_blocks(fcd_file, _chunk) && (left + _chunk - 1) / _chunk * _chunk < rest) {
+        //  up to a block boundary, the rest of the file - the next slices
+        rest = (left + _chunk - 1) / _chunk * _chunk;
+        if (!_rolling->offset) _rolling->since = _now;
+        _rolling->offset += rest;
+        coverage->covered += rest;
+        break;
+      }
+      //  a file without block digests - whole, over the budget
+      left = rest;
+    }
+    left -= rest;
+    coverage->covered += rest;
+  }
+  _rolling->cursor = n;
+  _rolling->end_index = n;
+  _rolling->end_offset = n < _etalon->count ? _rolling->offset : 0;
+  if (n < _etalon->count) return 0;
+  coverage->cycle_last = _now;
+  return 1;
+}
+
+/*
+ * int fcd_rolling_range( const struct FCD_ROLLING *rolling, uint32_t index, uint64_t size, uint64_t *from,
+ *                        uint64_t *to );
+ *
+ * The function fcd_rolling_range() returns 1 and the bytes [from, to) of the
+ * file to read, if the file index is in the slice; 0 - not in the slice.
+ */
+int fcd_rolling_range(const struct FCD_ROLLING *_rolling, uint32_t _index, uint64_t _size, uint64_t *_from,
+                      uint64_t *_to) {
+  if (_index < _rolling->start_index || _index > _rolling->end_index) return 0;
+  if (_index == _rolling->end_index && !_rolling->end_offset) return 0;
+  *_from = _index == _rolling->start_index ? _rolling->start_offset : 0;
+  *_to = _index == _rolling->end_index ? _rolling->end_offset : _size;
+  if (*_to > _size) *_to = _size;
+  return *_from < *_to || !_size;
+}
+
+//  CRC-32 of the header (checksum is 0) and the times - a torn or damaged file moves no cursor
+static uint32_t fcd_rolling_checksum(const struct FCD_ROLLING_HEADER *_header, const void *_times, size_t _body) {
+  struct FCD_ROLLING_HEADER header = *_header;
+  header.checksum = 0;
+  return crc32_finish(crc32_update_block(crc32_update_block(crc32_start(), &header, sizeof(header)), _times, _body));
+}
+
+//  the signature of the etalon file - the state belongs to this etalon only
+static int fcd_rolling_etadb(const char *_etalon_file, struct FCD_STAT *_sig) {
+  struct stat st;
+  memset(_sig, 0, sizeof(struct FCD_STAT));
+  if (stat(_etalon_file, &st)) return errno;
+  fcd_stat_sig(_sig, &st);
+  return 0;
+}
+
+/*
+ * int fcd_rolling_save( struct FCD_ROLLING *rolling, struct FCD_ETALON *etalon, const char *etalon_file,
+ *                       const char **errop );
+ *
+ * The function fcd_rolling_save() writes the cursor, the progress of the cycle
+ * and the times of verification to etalon_file.rolling atomically. Returns 0
+ * or errno (errop - the failed operation).
+ */
+int fcd_rolling_save(struct FCD_ROLLING *_rolling, struct FCD_ETALON *_etalon, const char *_etalon_file,
+                     const char **_errop) {
+  int cc = 0;
+  struct FCD_ROLLING_HEADER header;
+  char file[strlen(_etalon_file) + sizeof(FCD_ROLLING_SUFFIX)];
+  char tmp[sizeof(file) + 4];
+  snprintf(file, sizeof(file), "%s%s", _etalon_file, FCD_ROLLING_SUFFIX);
+  snprintf(tmp, sizeof(tmp), "%s.tmp", file);
+  *_errop = NULL;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, FCD_ROLLING_MAGIC, sizeof(header.magic));
+  header.version = FCD_ROLLING_VERSION;
+  if ((cc = fcd_rolling_etadb(_etalon_file, &header.etadb))) {
+    *_errop = "stat(etalon)";
+    return cc;
+  }
+  header.cursor = _rolling->cursor;
+  header.offset = _rolling->offset;
+  header.since = _rolling->since;
+  header.cycle = _rolling->coverage.cycle;
+  header.intervals = _rolling->coverage.intervals;
+  header.covered = _rolling->coverage.covered;
+  header.cycle_start = _rolling->coverage.cycle_start;
+  header.cycle_last = _rolling->coverage.cycle_last;
+  header.count = _etalon->count;
+  size_t body = sizeof(uint32_t) * _etalon->count;
+  uint32_t *times = my_malloc(body ? body : 1);
+  for (size_t n = 0; n < _etalon->count; ++n) times[n] = fcd_file_verified(fcd_etalon_file(_etalon, n));
+  header.checksum = fcd_rolling_checksum(&header, times, body);
+  int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    free(times);
+    *_errop = "open";
+    return errno;
+  }
+  errno = 0;
+  if (write(fd, &header, sizeof(header)) != sizeof(header) || (body && write(fd, times, body) != (ssize_t)body)) {
+    *_errop = "write";
+    cc = errno ? errno : EIO;
+  }
+  free(times);
+  if (!cc && fsync(fd)) {
+    *_errop = "fsync";
+    cc = errno;
+  }
+  if (close(fd) && !cc) {
+    *_errop = "close";
+    cc = errno;
+  }
+  if (!cc && rename(tmp, file)) {
+    *_errop = "rename";
+    cc = errno;
+  }
+  if (cc) unlink(tmp);
+  return cc;
+}
+
+/*
+ * int fcd_rolling_load( struct FCD_ROLLING *rolling, struct FCD_ETALON *etalon, const char *etalon_file,
+ *                       const char **errop );
+ *
+ * The function fcd_rolling_load() restores the cursor, the progress of the
+ * cycle and the times of verification of the loaded etalon list from
+ * etalon_file.rolling. Returns 0, ENOENT (no file), EBADMSG (corrupted file),
+ * ESTALE (the state of another etalon file) or errno; not 0 - the state is
+ * untouched.
+ */
+int fcd_rolling_load(struct FCD_ROLLING *_rolling, struct FCD_ETALON *_etalon, const char *_etalon_file,
+                     const char **_errop) {
+  struct stat st;
+  struct FCD_STAT etadb;
+  char file[strlen(_etalon_file) + sizeof(FCD_ROLLING_SUFFIX)];
+  snprintf(file, sizeof(file), "%s%s", _etalon_file, FCD_ROLLING_SUFFIX);
+  int fd = open(file, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    *_errop = "open";
+    return errno;
+  }
+  if (fstat(fd, &st)) {
+    int cc = errno;
+    close(fd);
+    *_errop = "fstat";
+    return cc;
+  }
+  if ((size_t)st.st_size < sizeof(struct FCD_ROLLING_HEADER)) {
+    close(fd);
+    *_errop = "header";
+    return EBADMSG;
+  }
+  const unsigned char *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    *_errop = "mmap";
+    return errno;
+  }
+  const struct FCD_ROLLING_HEADER *header = (const struct FCD_ROLLING_HEADER *)map;
+  uint64_t body = st.st_size - sizeof(struct FCD_ROLLING_HEADER);
+  int cc = 0;
+  if (memcmp(header->magic, FCD_ROLLING_MAGIC, sizeof(header->magic)) || header->version != FCD_ROLLING_VERSION ||
+      header->count != body / sizeof(uint32_t) || body % sizeof(uint32_t)) {
+    *_errop = "header";
+    cc = EBADMSG;
+  } else if (fcd_rolling_checksum(header, header + 1, body) != header->checksum) {
+    *_errop = "checksum";
+    cc = EBADMSG;
+  } else if (fcd_rolling_etadb(_etalon_file, &etadb) || memcmp(&etadb, &header->etadb, sizeof(etadb))) {
+    //  the etalon was calculated again after the state was written
+    *_errop = "etalon";
+    cc = ESTALE;
+  }
+  if (cc) {
+    munmap((void *)map, st.st_size);
+    return cc;
+  }
+  const uint32_t *times = (const uint32_t *)(header + 1);
+  for (size_t n = 0; n < header->count && n < _etalon->count; ++n)
+    fcd_file_verified_set(fcd_etalon_file(_etalon, n), times[n]);
+  _rolling->cursor = header->cursor;
+  _rolling->offset = header->offset;
+  _rolling->since = header->since;
+  _rolling->coverage.cycle = header->cycle;
+  _rolling->coverage.intervals = header->intervals;
+  _rolling->coverage.covered = header->covered;
+  _rolling->coverage.cycle_start = header->cycle_start;
+  _rolling->coverage.cycle_last = header->cycle_last;
+  munmap((void *)map, st.st_size);
+  return 0;
+}
@@ -0,0 +1,81 @@
+/*
+ *  File Check Daemon - скользящая выборочная проверка (rolling)
+ *
+ *  - каждое полное (не глубокое) сканирование читает, даже при неизменной подписи
+ *    stat(), срез эталонных файлов (OLD) размером budget байт: budget - параметр
+ *    rolling, но не меньше 1/cycle от байт всех файлов - весь список проверяется
+ *    не более чем за cycle сканирований (цикл)
+ *  - срез - от курсора (номер файла и смещение в нём) по порядку номеров записей;
+ *    файл с суммами блоков режется по границе блока (chunk), читаются только его
+ *    блоки среза, остальные - из сумм эталона; файл без сумм блоков берётся целиком
+ *    (срез больше budget не более чем на один такой файл)
+ *  - файлы с изменённой подписью читаются и вне среза, как всегда
+ *  - время последней проверки файла целиком (verified) - в записи эталонного списка;
+ *    файл, прочитанный несколькими срезами, проверен с начала первого из них (since)
+ *  - курсор, ход цикла и времена проверки - в файле etalon.rolling (рядом с файлом
+ *    etalon), пишется после каждого среза; подпись stat() файла etalon в нём: другой
+ *    эталон (rebase) - новый цикл с начала
+ */
+#ifndef FICHEDA_ROLLING_H
+#define FICHEDA_ROLLING_H
+
+#include <stdint.h>
+#include "etalon.h"
+
+#define FCD_ROLLING_MAGIC     "FCDROLL1"
+#define FCD_ROLLING_VERSION   1
+#define FCD_ROLLING_SUFFIX    ".rolling"
+
+//  the progress of the cycle, a copy goes to every report
+struct FCD_COVERAGE {
+    uint64_t cycle;
+    uint32_t intervals;
+    uint64_t covered;
+    uint64_t total;
+    int64_t cycle_start;
+    int64_t cycle_last;
+    //  of the report: the least recent verification of an etalon file, files never verified
+    int64_t oldest;
+    uint64_t never;
+};
+
+struct FCD_ROLLING {
+    //  the next slice starts here: the file, bytes of it done, when its first range was read
+    uint32_t cursor;
+    uint64_t offset;
+    int64_t since;
+    struct FCD_COVERAGE coverage;
+    //  the slice of the scan: [start, end) in (file, offset)
+    uint32_t start_index;
+    uint64_t start_offset;
+    int64_t start_since;
+    uint32_t end_index;
+    uint64_t end_offset;
+};
+
+struct FCD_ROLLING_HEADER {
+    char magic[8];
+    uint32_t version;
+    uint32_t checksum;
+    struct FCD_STAT etadb;
+    uint32_t cursor;
+    uint64_t offset;
+    int64_t since;
+    uint64_t cycle;
+    uint32_t intervals;
+    uint64_t covered;
+    int64_t cycle_start;
+    int64_t cycle_last;
+    uint64_t count;
+};
+
+int fcd_rolling_slice(struct FCD_ROLLING *_rolling, struct FCD_ETALON *_etalon, uint64_t _budget, int _cycle,
+                      uint64_t _chunk, int64_t _now);
+int fcd_rolling_range(const struct FCD_ROLLING *_rolling, uint32_t _index, uint64_t _size, uint64_t *_from,
+                      uint64_t *_to);
+int fcd_rolling_load(struct FCD_ROLLING *_rolling, struct FCD_ETALON *_etalon, const char *_etalon_file,
+                     const char **_errop);
+int fcd_rolling_save(struct FCD_ROLLING *_rolling, struct FCD_ETALON *_etalon, const char *_etalon_file,
+                     const char **_errop);
+
+#endif //FICHEDA_ROLLING_H
@@ -14,11 +14,22 @@
 #   -   восстановление всех файлов в начальное состояние
 #   -   проверка последнего JSON-файла на OK
 #   -   остановка демона
+#   -   известные суммы всех алгоритмов (algorithm) - файл целиком и частями (split)
+#   -   файл etalon: загрузка сохранённого, отказ от обрезанного и повреждённого
+#   -   rolling: цикл продолжается после перезапуска, обрезанный или повреждённый etalon.rolling - новый цикл
+#   -   socket: пути с "..", "." и "//" не принимаются, файл вне миссии не попадает в эталон
+#   -   событие inotify: изменённый файл - FAIL без сканирования по интервалу и без USR1
+#   -   движки чтения (read) целиком и частями (split) - те же суммы, что у zlib.crc32
+#   -   recursive: файлы нового вложенного каталога - NEW, файлы удалённого - DELETED, без интервала
+#   -   журнал changes: строка на смену статуса (from null / OK), ротация в changes.1 после rotate байт
+#   -   суммы блоков (blocks): диапазон изменённого блока, verify=append - выросший файл OK и в файле etalon
+#   -   config: две миссии в одном процессе, общие значения и значения секций, общий параметр в секции - отказ
 #   -   завершение работы
 #
 
 import os
 import random
+import socket
 import time
 import string
 import zlib
@@ -51,8 +62,12 @@ def ficheda_failure(failure_message):
 
 
 def ficheda_must_be():
-    if not is_ficheda_running():
-        ficheda_failure("Daemon 'ficheda' must be!")
+    # a single "ps" may miss the daemon busy at its start
+    for ii in range(5):
+        if is_ficheda_running():
+            return
+        time.sleep(0.1)
+    ficheda_failure("Daemon 'ficheda' must be!")
 
 
 def crc32(file_name_for_crc32):
@@ -184,12 +199,519 @@ def ficheda_sigusr1():
     os.popen("killall -USR1 ficheda")
 
 
+def ficheda_start(start_args):
+    start_cmd = f"./bin/ficheda {start_args}"
+    print(start_cmd)
+    os.popen(start_cmd).close()
+
+
+def ficheda_stop():
+    os.popen("killall -TERM ficheda").close()
+    for ii in range(100):
+        if not is_ficheda_running():
+            return
+        time.sleep(0.1)
+    ficheda_failure("Daemon 'ficheda' does not stop!")
+
+
+def wait_json(json_name):
+    # the JSON-file is renamed in place - it exists only whole
+    for ii in range(300):
+        if os.path.exists(json_name):
+            with open(json_name) as json_in:
+                return json.load(json_in)
+        ficheda_must_be()
+        time.sleep(0.1)
+    ficheda_failure(f"No JSON-file '{json_name}'!")
+
+
+def wait_report(json_name, report_check, seconds):
+    # the first JSON-file that passes report_check, None - not in time
+    for ii in range(int(seconds * 20)):
+        if os.path.exists(json_name):
+            with open(json_name) as json_in:
+                report_array = json.load(json_in)
+            if report_check(report_array):
+                return report_array
+        ficheda_must_be()
+        time.sleep(0.05)
+    return None
+
+
+def report_status(report_array, path):
+    # the status of the file in the report, None - not in it
+    for entry in report_array:
+        if entry.get("path") == path:
+            return entry["status"]
+    return None
+
+
+def write_random(file_name, size, mode="wb"):
+    with open(file_name, mode) as random_out:
+        random_out.write(os.urandom(size))
+
+
+def remake_dir(dir_name):
+    os.popen(f"rm -rf {dir_name}").close()
+    os.mkdir(dir_name)
+
+
 def ficheda_sigterm():
     print("\nkillall -TERM ficheda")
     os.popen("killall -TERM ficheda")
     print("\nBay!")
 
 
+# known answers: bytes i % 251, as the BLAKE3 test vectors
+kat_dir = "/tmp/ficheda_kat"
+kat_json = "/tmp/ficheda_kat.json"
+kat_digests = {
+    0: ["0x00000000", "0x00000000", "0x2D06800538D394C2",
+        "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262"],
+    1: ["0xD202EF8D", "0x527D5351", "0xC44BDFF4074EECDB",
+        "2d3adedff11b61f14c886e35afa036736dcd87a74d27b5c1510225d0f592e213"],
+    1023: ["0x5A9E0EFF", "0x39A4911A", "0xD3D91D80AC495685",
+           "10108970eeda3eb932baac1428c7a2163b0e924c9a9e25b35bba72b28f70bd11"],
+    1024: ["0x7BE4DFD0", "0x2AF62C0C", "0xE5D78BAFA45B2AA5",
+           "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7"],
+    1025: ["0x4E700DFB", "0xC8D03ADD", "0xE95C42288F28186E",
+           "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444"],
+    65537: ["0xA9CC6E73", "0x4537BB82", "0x70331D53D92BBC56",
+            "7c99f9840a73dfcb6e5bfe4ff6d1558acab7e015640790c26411818bdbe17eca"],
+    3145745: ["0x887A6EE4", "0x2CBA3808", "0xFB45FCD49E8371B7",
+              "26003c63117013de5d02be76e5e32a2f75bfbc075f17180fd5f9f0b4752d2bfe"],
+}
+kat_algorithms = ["crc32", "crc32c", "xxh3", "blake3"]
+
+
+def test_digest_vectors():
+    # every algorithm: the file hashed whole, then in parts of 1 MiB merged (split)
+    print("\nNow... known answers of the algorithms...")
+    remake_dir(kat_dir)
+    pattern = bytes(ii % 251 for ii in range(max(kat_digests.keys())))
+    for length in kat_digests.keys():
+        with open(f"{kat_dir}/kat_{length}", "wb") as kat_out:
+            kat_out.write(pattern[:length])
+    for algorithm_index, algorithm in enumerate(kat_algorithms):
+        for split_args in ["-s 0", "-s 1M -k 1M"]:
+            os.popen(f"rm -f {kat_json}").close()
+            ficheda_start(f"-p {kat_dir} -i 1 -j {kat_json} -a {algorithm} {split_args}")
+            kat_array = wait_json(kat_json)
+            ficheda_stop()
+            if len(kat_array) != len(kat_digests):
+                ficheda_failure(f"{algorithm}: {len(kat_array)} entries in JSON-file, {len(kat_digests)} files.")
+            for entry in kat_array:
+                length = int(entry["path"].rsplit("_", 1)[1])
+                expected = kat_digests[length][algorithm_index]
+                if entry["status"] != "OK" or entry.get(f"etalon_{algorithm}") != expected:
+                    ficheda_failure(f"{algorithm} {split_args}: {entry}, expected {expected}.")
+            print(f"Success! {algorithm} {split_args}: all known answers.")
+
+
+eta_dir = "/tmp/ficheda_eta"
+eta_json = "/tmp/ficheda_eta.json"
+eta_file = "/tmp/ficheda_eta.db"
+
+
+def etadb_rejected(eta_data, what):
+    # the daemon must not start on a broken etalon file
+    with open(eta_file, "wb") as eta_out:
+        eta_out.write(eta_data)
+    ficheda_start(f"-p {eta_dir} -i 1 -j {eta_json} -e {eta_file}")
+    time.sleep(2)
+    if is_ficheda_running():
+        ficheda_failure(f"Etalon file {what} is loaded!")
+    print(f"Success! Etalon file {what} is rejected.")
+
+
+def test_etadb_load():
+    print("\nNow... etalon file: save, load, truncated and corrupted...")
+    remake_dir(eta_dir)
+    for ii in range(3):
+        create_fill_new_file(f"{eta_dir}/file_{ii}.data")
+    os.popen(f"rm -f {eta_json} {eta_file}").close()
+    ficheda_start(f"-p {eta_dir} -i 1 -j {eta_json} -e {eta_file}")
+    wait_json(eta_json)
+    ficheda_stop()
+    with open(eta_file, "rb") as eta_in:
+        eta_data = eta_in.read()
+    # loaded list - the files are not read, their stat() signature is the same
+    os.popen(f"rm -f {eta_json}").close()
+    ficheda_start(f"-p {eta_dir} -i 1 -j {eta_json} -e {eta_file}")
+    eta_array = wait_json(eta_json)
+    ficheda_stop()
+    if len(eta_array) != 3 or any(e["status"] != "OK" or e.get("source") != "metadata" for e in eta_array):
+        ficheda_failure(f"Etalon file is not loaded: {eta_array}")
+    print("Success! Etalon file is loaded.")
+    # header: magic, version, checksum (CRC-32 of the rest) at 12, ..., names_size at 32; records from 64
+    if int.from_bytes(eta_data[12:16], "little") != zlib.crc32(eta_data[64:]):
+        ficheda_failure("Etalon file checksum is not CRC-32 of the body!")
+    etadb_rejected(eta_data[:40], "with a short header")
+    etadb_rejected(eta_data[:len(eta_data) // 2], "cut in half")
+    etadb_rejected(eta_data[:100] + bytes([eta_data[100] ^ 1]) + eta_data[101:], "with a flipped bit")
+    # the first record names past the names - the checksum is right, the record is not
+    bad_data = bytearray(eta_data)
+    bad_data[72:80] = eta_data[32:40]
+    bad_data[12:16] = zlib.crc32(bytes(bad_data[64:])).to_bytes(4, "little")
+    etadb_rejected(bytes(bad_data), "with a bad record")
+    with open(eta_file, "wb") as eta_out:
+        eta_out.write(eta_data)
+
+
+roll_dir = "/tmp/ficheda_roll"
+roll_json = "/tmp/ficheda_roll.json"
+roll_eta = "/tmp/ficheda_roll.db"
+roll_args = f"-p {roll_dir} -i 1 -g 100 -j {roll_json} -e {roll_eta} -L 50K"
+
+
+def rolling_first_cycle():
+    # the cycle of the first report after the start
+    os.popen(f"rm -f {roll_json}").close()
+    ficheda_start(roll_args)
+    roll_array = wait_json(roll_json)
+    ficheda_stop()
+    if "rolling" not in roll_array[0]:
+        ficheda_failure(f"No rolling progress in JSON-file: {roll_array[0]}")
+    return roll_array[0]["rolling"]["cycle"]
+
+
+def test_rolling_state():
+    print("\nNow... rolling verification state across restarts...")
+    remake_dir(roll_dir)
+    # one file per scan (no block digests - whole), four scans per cycle
+    for ii in range(4):
+        with open(f"{roll_dir}/file_{ii}.data", "wb") as roll_out:
+            roll_out.write(os.urandom(100000))
+    os.popen(f"rm -f {roll_json} {roll_eta} {roll_eta}.rolling").close()
+    ficheda_start(roll_args)
+    for ii in range(300):
+        if os.path.exists(roll_json):
+            with open(roll_json) as roll_in:
+                if json.load(roll_in)[0]["rolling"]["cycle"] >= 2:
+                    break
+        ficheda_must_be()
+        time.sleep(0.1)
+    ficheda_stop()
+    with open(roll_eta + ".rolling", "rb") as roll_in:
+        roll_data = roll_in.read()
+    cycle = rolling_first_cycle()
+    if cycle < 2:
+        ficheda_failure(f"Rolling state is not loaded: cycle {cycle} after restart.")
+    print(f"Success! Rolling cycle {cycle} goes on after restart.")
+    # header: magic, version, checksum, etalon signature (36 bytes), cursor at 52
+    for roll_bad, what in [(roll_data[:20], "truncated"),
+                           (roll_data[:52] + bytes([roll_data[52] ^ 1]) + roll_data[53:], "with a flipped cursor")]:
+        with open(roll_eta + ".rolling", "wb") as roll_out:
+            roll_out.write(roll_bad)
+        cycle = rolling_first_cycle()
+        if cycle != 1:
+            ficheda_failure(f"Rolling state {what} is loaded: cycle {cycle}.")
+        print(f"Success! Rolling state {what} - new cycle.")
+
+
+ctl_dir = "/tmp/ficheda_ctl"
+ctl_json = "/tmp/ficheda_ctl.json"
+ctl_socket = "/tmp/ficheda_ctl.sock"
+
+
+def control_request(request):
+    # one request line, one answer line
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as ctl:
+        ctl.connect(ctl_socket)
+        ctl.sendall((request + "\n").encode())
+        with ctl.makefile() as ctl_in:
+            return json.loads(ctl_in.readline())
+
+
+def test_control_paths():
+    print("\nNow... control socket paths...")
+    remake_dir(ctl_dir)
+    os.mkdir(f"{ctl_dir}/m")
+    create_fill_new_file(f"{ctl_dir}/m/a")
+    create_fill_new_file(f"{ctl_dir}/outside")
+    os.popen(f"rm -f {ctl_json} {ctl_socket}").close()
+    ficheda_start(f"-p {ctl_dir}/m -i 100 -j {ctl_json} -S {ctl_socket}")
+    # the socket listens after the initial calculation
+    for ii in range(100):
+        try:
+            control_request("scan")
+            break
+        except OSError:
+            ficheda_must_be()
+            time.sleep(0.1)
+    for path in [f"{ctl_dir}/m/../outside", f"{ctl_dir}/m/./a", f"{ctl_dir}/m//a"]:
+        answer = control_request(f"verify {path}")
+        if answer != {"files": [{"path": path, "error": "not a canonical path"}]}:
+            ficheda_failure(f"verify {path}: {answer}")
+        print(f"Success! verify {path} is refused.")
+    answer = control_request(f"status {ctl_dir}/m/../m/a")
+    if answer.get("error") != "not a canonical path":
+        ficheda_failure(f"status of a non-canonical path: {answer}")
+    answer = control_request(f"verify {ctl_dir}/m/a")
+    if len(answer["files"]) != 1 or answer["files"][0].get("status") != "OK":
+        ficheda_failure(f"verify {ctl_dir}/m/a: {answer}")
+    # the etalon list holds the mission file only
+    answer = control_request("scan")
+    ficheda_stop()
+    if answer["missions"][0]["files"] != 1:
+        ficheda_failure(f"Etalon list of the mission: {answer}")
+    print("Success! Control socket paths.")
+
+
+ino_dir = "/tmp/ficheda_ino"
+ino_json = "/tmp/ficheda_ino.json"
+
+
+def test_targeted_rescan():
+    # interval far away: only the inotify event of the file triggers its scan
+    print("\nNow... targeted rescan from inotify...")
+    remake_dir(ino_dir)
+    for ii in range(3):
+        write_random(f"{ino_dir}/file_{ii}.data", 100000)
+    os.popen(f"rm -f {ino_json}").close()
+    ficheda_start(f"-p {ino_dir} -i 1000 -w 50 -g 100 -j {ino_json}")
+    time.sleep(1)
+    if os.path.exists(ino_json):
+        ficheda_failure("A report without any event!")
+    change_start = time.time()
+    write_random(f"{ino_dir}/file_1.data", 100000)
+    ino_array = wait_report(ino_json, lambda a: report_status(a, f"{ino_dir}/file_1.data") == "FAIL", 1.5)
+    change_time = time.time() - change_start
+    ficheda_stop()
+    if ino_array is None:
+        ficheda_failure("No FAIL of the changed file in 1.5 s!")
+    if report_status(ino_array, f"{ino_dir}/file_0.data") != "OK":
+        ficheda_failure(f"Unchanged file is not OK: {ino_array}")
+    print(f"Success! FAIL of the changed file in {change_time:.2f} s, no interval scan.")
+
+
+read_dir = "/tmp/ficheda_read"
+read_json = "/tmp/ficheda_read.json"
+
+
+def test_read_engines():
+    # sizes around a page, a chunk and several chunks
+    print("\nNow... read engines...")
+    remake_dir(read_dir)
+    read_crc32 = {}
+    for size in [0, 4095, 4097, 1048577, 9000000]:
+        file_name = f"{read_dir}/file_{size}.data"
+        write_random(file_name, size)
+        read_crc32[file_name] = "0x" + crc32(file_name)
+    for read_mode in ["buffered", "mmap", "direct", "uring"]:
+        for split_args in ["-s 0", "-s 2M -k 1M"]:
+            os.popen(f"rm -f {read_json}").close()
+            ficheda_start(f"-p {read_dir} -i 1 -j {read_json} -m {read_mode} {split_args}")
+            read_array = wait_json(read_json)
+            ficheda_stop()
+            if len(read_array) != len(read_crc32):
+                ficheda_failure(f"{read_mode}: {len(read_array)} entries in JSON-file, {len(read_crc32)} files.")
+            for entry in read_array:
+                if entry["status"] != "OK" or entry.get("etalon_crc32") != read_crc32[entry["path"]]:
+                    ficheda_failure(f"{read_mode} {split_args}: {entry}, expected {read_crc32[entry['path']]}.")
+            print(f"Success! {read_mode} {split_args}: all CRC-32 as zlib.")
+
+
+tree_dir = "/tmp/ficheda_tree"
+tree_json = "/tmp/ficheda_tree.json"
+
+
+def test_recursive_tree():
+    print("\nNow... recursive tree...")
+    remake_dir(tree_dir)
+    os.makedirs(f"{tree_dir}/old/sub")
+    write_random(f"{tree_dir}/top.data", 1000)
+    write_random(f"{tree_dir}/old/sub/file.data", 1000)
+    os.popen(f"rm -f {tree_json}").close()
+    ficheda_start(f"-p {tree_dir} -R 1 -i 1000 -w 50 -g 100 -j {tree_json}")
+    time.sleep(1)
+    # a directory made at runtime - watched, its files by the relative path
+    os.makedirs(f"{tree_dir}/new/deep")
+    write_random(f"{tree_dir}/new/deep/file.data", 1000)
+    tree_array = wait_report(tree_json, lambda a: report_status(a, f"{tree_dir}/new/deep/file.data") == "NEW", 3)
+    if tree_array is None:
+        ficheda_failure("No NEW file of the new nested directory!")
+    print("Success! File of the new nested directory is NEW.")
+    write_random(f"{tree_dir}/new/deep/later.data", 1000)
+    if wait_report(tree_json, lambda a: report_status(a, f"{tree_dir}/new/deep/later.data") == "NEW", 3) is None:
+        ficheda_failure("New nested directory is not watched!")
+    print("Success! New nested directory is watched.")
+    os.popen(f"rm -rf {tree_dir}/old").close()
+    tree_array = wait_report(tree_json, lambda a: report_status(a, f"{tree_dir}/old/sub/file.data") == "DELETED", 3)
+    ficheda_stop()
+    if tree_array is None:
+        ficheda_failure("File of the removed directory is not DELETED!")
+    if report_status(tree_array, f"{tree_dir}/top.data") != "OK":
+        ficheda_failure(f"Top file is not OK: {tree_array}")
+    print("Success! File of the removed directory is DELETED.")
+
+
+log_dir = "/tmp/ficheda_log"
+log_json = "/tmp/ficheda_log.json"
+log_file = "/tmp/ficheda_log.ndjson"
+
+
+def read_log_lines(log_name):
+    if not os.path.exists(log_name):
+        return []
+    with open(log_name) as log_in:
+        return [json.loads(log_line) for log_line in log_in]
+
+
+def wait_log_line(path, status, seconds):
+    # the change line of the file, None - not in time
+    for ii in range(int(seconds * 20)):
+        for log_line in read_log_lines(log_file):
+            if log_line["path"] == path and log_line["status"] == status:
+                return log_line
+        ficheda_must_be()
+        time.sleep(0.05)
+    return None
+
+
+def test_changes_log():
+    print("\nNow... changes log...")
+    remake_dir(log_dir)
+    for ii in range(2):
+        write_random(f"{log_dir}/file_{ii}.data", 1000)
+    os.popen(f"rm -f {log_json} {log_file} {log_file}.1").close()
+    ficheda_start(f"-p {log_dir} -i 1 -w 50 -g 100 -j {log_json} -l {log_file} -z 1K")
+    # the first report: all OK - not a change
+    wait_json(log_json)
+    write_random(f"{log_dir}/file_0.data", 1000)
+    fail_line = wait_log_line(f"{log_dir}/file_0.data", "FAIL", 3)
+    if fail_line is None or fail_line["from"] != "OK":
+        ficheda_failure(f"No OK to FAIL line: {read_log_lines(log_file)}")
+    write_random(f"{log_dir}/new_0.data", 1000)
+    new_line = wait_log_line(f"{log_dir}/new_0.data", "NEW", 3)
+    if new_line is None or new_line["from"] is not None:
+        ficheda_failure(f"No null to NEW line: {read_log_lines(log_file)}")
+    # the next full scans change nothing - no more lines
+    time.sleep(2.5)
+    log_lines = read_log_lines(log_file)
+    if len(log_lines) != 2:
+        ficheda_failure(f"Not a line per change: {log_lines}")
+    for log_line in log_lines:
+        if not all(key in log_line for key in ["seq", "time", "from", "status"]):
+            ficheda_failure(f"Change line without seq, time, from or status: {log_line}")
+    if log_lines[0]["seq"] >= log_lines[1]["seq"]:
+        ficheda_failure(f"Change lines out of order: {log_lines}")
+    print("Success! A line per change, from OK and from null.")
+    # more changes - the log grows over rotate bytes and goes to .1
+    for ii in range(1, 30):
+        if os.path.exists(f"{log_file}.1"):
+            break
+        write_random(f"{log_dir}/new_{ii}.data", 1000)
+        wait_log_line(f"{log_dir}/new_{ii}.data", "NEW", 3)
+    ficheda_stop()
+    rotated_lines = read_log_lines(f"{log_file}.1")
+    if not rotated_lines or rotated_lines[0] != log_lines[0] or os.path.getsize(f"{log_file}.1") < 1024:
+        ficheda_failure(f"Changes log is not rotated: {rotated_lines}")
+    print("Success! Changes log is rotated.")
+
+
+blk_dir = "/tmp/ficheda_blk"
+blk_json = "/tmp/ficheda_blk.json"
+blk_eta = "/tmp/ficheda_blk.db"
+blk_args = f"-p {blk_dir} -i 1 -w 50 -g 100 -j {blk_json} -e {blk_eta} -B 1M -k 1M -v append"
+
+
+def report_entry(report_array, path):
+    for entry in report_array:
+        if entry.get("path") == path:
+            return entry
+    return {}
+
+
+def test_block_digests():
+    print("\nNow... block digests...")
+    remake_dir(blk_dir)
+    write_random(f"{blk_dir}/big.data", 3500000)
+    write_random(f"{blk_dir}/log.data", 2000000)
+    os.popen(f"rm -f {blk_json} {blk_eta}").close()
+    ficheda_start(blk_args)
+    wait_json(blk_json)
+    # 4 bytes in the third block, the other file only grows
+    with open(f"{blk_dir}/big.data", "r+b") as blk_out:
+        blk_out.seek(2500000)
+        blk_out.write(b"FCD!")
+    write_random(f"{blk_dir}/log.data", 500000, "ab")
+    blk_array = wait_report(blk_json, lambda a: report_status(a, f"{blk_dir}/big.data") == "FAIL" and
+                            report_entry(a, f"{blk_dir}/log.data").get("result_crc32") ==
+                            "0x" + crc32(f"{blk_dir}/log.data"), 5)
+    ficheda_stop()
+    if blk_array is None:
+        ficheda_failure("No FAIL of the changed file or no value of the grown one!")
+    big_entry = report_entry(blk_array, f"{blk_dir}/big.data")
+    if big_entry.get("changed") != [[2097152, 3145728]]:
+        ficheda_failure(f"Changed ranges: {big_entry}")
+    print("Success! Changed block [2097152, 3145728).")
+    log_entry = report_entry(blk_array, f"{blk_dir}/log.data")
+    if log_entry["status"] != "OK" or log_entry["etalon_crc32"] != log_entry["result_crc32"]:
+        ficheda_failure(f"Grown file: {log_entry}")
+    print("Success! Grown file is OK (verify=append).")
+    # the appended blocks are in the etalon file
+    os.popen(f"rm -f {blk_json}").close()
+    ficheda_start(blk_args)
+    blk_array = wait_json(blk_json)
+    ficheda_stop()
+    log_entry = report_entry(blk_array, f"{blk_dir}/log.data")
+    if log_entry.get("status") != "OK" or log_entry.get("source") != "metadata":
+        ficheda_failure(f"Grown file after restart: {log_entry}")
+    if report_status(blk_array, f"{blk_dir}/big.data") != "FAIL":
+        ficheda_failure(f"Changed file after restart: {blk_array}")
+    print("Success! Grown file after restart - OK from metadata, changed file - FAIL.")
+
+
+cfg_dir = "/tmp/ficheda_cfg"
+cfg_file = "/tmp/ficheda_cfg.conf"
+
+
+def write_config(config_text):
+    with open(cfg_file, "w") as cfg_out:
+        cfg_out.write(config_text)
+
+
+def test_config_missions():
+    print("\nNow... missions of a config file...")
+    remake_dir(cfg_dir)
+    for mission in ["a", "b"]:
+        os.mkdir(f"{cfg_dir}/{mission}")
+        for ii in range(2):
+            write_random(f"{cfg_dir}/{mission}/file_{ii}.data", 1000)
+    os.popen(f"rm -f {cfg_dir}_a.json {cfg_dir}_b.json").close()
+    # interval of the mission b overrides the common one
+    write_config(f"# two missions\ndebounce = 50\ngap = 100\ninterval = 1\n\n"
+                 f"[a]\npath = {cfg_dir}/a\njson = {cfg_dir}_a.json\n\n"
+                 f"[b]\npath = {cfg_dir}/b\njson = {cfg_dir}_b.json\ninterval = 1000\n")
+    ficheda_start(f"-C {cfg_file}")
+    a_array = wait_json(f"{cfg_dir}_a.json")
+    if sorted(e["path"] for e in a_array) != [f"{cfg_dir}/a/file_0.data", f"{cfg_dir}/a/file_1.data"]:
+        ficheda_failure(f"JSON-file of the mission a: {a_array}")
+    time.sleep(1)
+    if os.path.exists(f"{cfg_dir}_b.json"):
+        ficheda_failure("Mission b reports with the common interval!")
+    print("Success! Mission a reports its own files, mission b keeps its own interval.")
+    write_random(f"{cfg_dir}/b/file_1.data", 1000)
+    b_array = wait_report(f"{cfg_dir}_b.json", lambda a: report_status(a, f"{cfg_dir}/b/file_1.data") == "FAIL", 3)
+    time.sleep(1.5)
+    a_array = wait_json(f"{cfg_dir}_a.json")
+    ficheda_stop()
+    if b_array is None or sorted(e["path"] for e in b_array) != [f"{cfg_dir}/b/file_0.data",
+                                                                 f"{cfg_dir}/b/file_1.data"]:
+        ficheda_failure(f"JSON-file of the mission b: {b_array}")
+    if any(e["status"] != "OK" or not e["path"].startswith(f"{cfg_dir}/a/") for e in a_array):
+        ficheda_failure(f"Change of the mission b in the JSON-file of the mission a: {a_array}")
+    print("Success! FAIL of the mission b only in its own JSON-file.")
+    # algorithm is common to all missions - not in a section
+    write_config(f"interval = 1\n[a]\npath = {cfg_dir}/a\njson = {cfg_dir}_a.json\nalgorithm = xxh3\n")
+    ficheda_start(f"-C {cfg_file}")
+    time.sleep(2)
+    if is_ficheda_running():
+        ficheda_failure("Common parameter in a section is taken!")
+    print("Success! Common parameter in a section is refused.")
+
+
 def create_fill_new_file(fname):
     try:
         new_fout = open(fname, "+w")
@@ -429,6 +951,19 @@ test_chn_file_mode()
 test_rtn_file_mode()
 the_last_file_must_be_perfect()
 
+# the tests below start a daemon of their own
+ficheda_stop()
+test_digest_vectors()
+test_etadb_load()
+test_rolling_state()
+test_control_paths()
+test_targeted_rescan()
+test_read_engines()
+test_recursive_tree()
+test_changes_log()
+test_block_digests()
+test_config_missions()
+
 # finish
 print("\nWait a few seconds...")
 time.sleep(wait_a_few_seconds)
@@ -0,0 +1,158 @@
+/*
+ *  File Check Daemon - обход дерева каталогов
+ *
+ *  Буфер getdents64() свой у каждого потока (выделяется один раз), буфер
+ *  чтения потока пула остаётся свободным для расчёта файлов прямо из обхода.
+ */
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "ficheda.h"
+#include "tree.h"
+
+struct FCD_DIRENT64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+static __thread char *fcd_tree_buff = NULL;
+
+//  the directory relative to the mission directory (dirfd), symlinks are not followed
+int fcd_tree_open(int _dirfd, const char *_path) {
+  int fd;
+  while ((fd = openat(_dirfd, *_path ? _path : ".", O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC)) < 0 &&
+         errno == EINTR);
+  return fd;
+}
+
+/*
+ * int fcd_tree_read( int dirfd, fcd_tree_entry_fn fn, void *ctx );
+ *
+ * The function fcd_tree_read() calls fn() for every entry of the directory
+ * except "." and "..", with its type and inode number. Returns 0 or errno of
+ * getdents64().
+ */
+int fcd_tree_read(int _dirfd, fcd_tree_entry_fn _fn, void *_ctx) {
+  struct stat st;
+  if (!fcd_tree_buff) fcd_tree_buff = my_malloc(FCD_TREE_BUFF);
+  while (1) {
+    long rl = syscall(SYS_getdents64, _dirfd, fcd_tree_buff, FCD_TREE_BUFF);
+    if (rl < 0) {
+      if (errno == EINTR) continue;
+      return errno;
+    }
+    if (rl == 0) return 0;
+    for (long pos = 0; pos < rl;) {
+      struct FCD_DIRENT64 *entry = (struct FCD_DIRENT64 *)(fcd_tree_buff + pos);
+      pos += entry->d_reclen;
+      const char *name = entry->d_name;
+      if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2]))) continue;
+      unsigned char type = entry->d_type;
+      //  the file system does not fill d_type
+      if (type == DT_UNKNOWN && fstatat(_dirfd, name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+        if (S_ISREG(st.st_mode)) type = DT_REG;
+        else if (S_ISDIR(st.st_mode)) type = DT_DIR;
+      }
+      _fn(_ctx, name, type, entry->d_ino);
+    }
+  }
+}
+
+void fcd_watches_init(struct FCD_WATCHES *_watches, const char *_root) {
+  if (pthread_mutex_init(&_watches->mutex, NULL)) severe_error_0("pthread_mutex_init(watches)", errno);
+  _watches->root = _root;
+  _watches->paths = NULL;
+  _watches->capacity = 0;
+}
+
+/*
+ *  наблюдение за каталогом, повторный вызов для того же каталога возвращает
+ *  прежний wd (путь обновляется - каталог мог быть переименован)
+ *  возвращает wd или -1 (errno)
+ */
+int fcd_watches_add(struct FCD_WATCHES *_watches, int _fd, const char *_path, uint32_t _mask) {
+  char full[PATH_MAX];
+  int fl = *_path ? snprintf(full, sizeof(full), "%s/%s", _watches->root, _path) : snprintf(full, sizeof(full), "%s", _watches->root);
+  if (fl < 0 || (size_t)fl >= sizeof(full)) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  int wd = inotify_add_watch(_fd, full, _mask);
+  if (wd < 0) return -1;
+  char *path = my_strdup((char *)_path);
+  //  lock mutex
+  if (pthread_mutex_lock(&_watches->mutex)) severe_error_0("pthread_mutex_lock(watches)", errno);
+  if (wd >= _watches->capacity) {
+    int capacity = _watches->capacity ? _watches->capacity : 64;
+    while (capacity <= wd) capacity *= 2;
+    char **paths = my_malloc(sizeof(char *) * capacity);
+    memset(paths, 0, sizeof(char *) * capacity);
+    if (_watches->capacity) memcpy(paths, _watches->paths, sizeof(char *) * _watches->capacity);
+    free(_watches->paths);
+    _watches->paths = paths;
+    _watches->capacity = capacity;
+  }
+  free(_watches->paths[wd]);
+  _watches->paths[wd] = path;
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_watches->mutex)) severe_error_0("pthread_mutex_unlock(watches)", errno);
+  return wd;
+}
+
+/*
+ *  относительный путь записи каталога wd в buff
+ *  возвращает 0 (wd неизвестен или путь не помещается) или 1
+ */
+int fcd_watches_name(struct FCD_WATCHES *_watches, int _wd, const char *_name, char *_buff, size_t _size) {
+  int ok = 0;
+  //  lock mutex
+  if (pthread_mutex_lock(&_watches->mutex)) severe_error_0("pthread_mutex_lock(watches)", errno);
+  if (_wd >= 0 && _wd < _watches->capacity && _watches->paths[_wd]) {
+    const char *path = _watches->paths[_wd];
+    int wl = *path ? snprintf(_buff, _size, "%s/%s", path, _name) : snprintf(_buff, _size, "%s", _name);
+    ok = wl >= 0 && (size_t)wl < _size;
+  }
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_watches->mutex)) severe_error_0("pthread_mutex_unlock(watches)", errno);
+  return ok;
+}
+
+//  the watch is gone (IN_IGNORED)
+void fcd_watches_drop(struct FCD_WATCHES *_watches, int _wd) {
+  //  lock mutex
+  if (pthread_mutex_lock(&_watches->mutex)) severe_error_0("pthread_mutex_lock(watches)", errno);
+  if (_wd >= 0 && _wd < _watches->capacity) {
+    free(_watches->paths[_wd]);
+    _watches->paths[_wd] = NULL;
+  }
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_watches->mutex)) severe_error_0("pthread_mutex_unlock(watches)", errno);
+}
+
+//  the directory left the tree - stop watching it and everything below
+void fcd_watches_drop_tree(struct FCD_WATCHES *_watches, int _fd, const char *_path) {
+  size_t len = strlen(_path);
+  //  lock mutex
+  if (pthread_mutex_lock(&_watches->mutex)) severe_error_0("pthread_mutex_lock(watches)", errno);
+  for (int wd = 0; wd < _watches->capacity; ++wd) {
+    char *path = _watches->paths[wd];
+    if (!path || strncmp(path, _path, len) || (path[len] && path[len] != '/')) continue;
+    inotify_rm_watch(_fd, wd);
+    free(path);
+    _watches->paths[wd] = NULL;
+  }
+  //  unlock mutex
+  if (pthread_mutex_unlock(&_watches->mutex)) severe_error_0("pthread_mutex_unlock(watches)", errno);
+}
@@ -0,0 +1,38 @@
+/*
+ *  File Check Daemon - обход дерева каталогов
+ *
+ *  - каталог читается getdents64() большими порциями в буфер потока
+ *  - тип записи из d_type, для DT_UNKNOWN - fstatat() относительно дескриптора каталога;
+ *    номер inode из d_ino - для порядка чтения (elevator.c)
+ *  - пути относительные (от каталога миссии, открывается через его дескриптор),
+ *    "" - сам каталог миссии
+ *  - наблюдения inotify по каталогам: wd -> относительный путь каталога (у
+ *    inotify_add_watch() нет варианта с дескриптором - полный путь от root)
+ */
+#ifndef FICHEDA_TREE_H
+#define FICHEDA_TREE_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FCD_TREE_BUFF     65536
+
+typedef void (*fcd_tree_entry_fn)(void *_ctx, const char *_name, unsigned char _type, uint64_t _ino);
+
+struct FCD_WATCHES {
+    pthread_mutex_t mutex;
+    const char *root;
+    char **paths;
+    int capacity;
+};
+
+int fcd_tree_open(int _dirfd, const char *_path);
+int fcd_tree_read(int _dirfd, fcd_tree_entry_fn _fn, void *_ctx);
+void fcd_watches_init(struct FCD_WATCHES *_watches, const char *_root);
+int fcd_watches_add(struct FCD_WATCHES *_watches, int _fd, const char *_path, uint32_t _mask);
+int fcd_watches_name(struct FCD_WATCHES *_watches, int _wd, const char *_name, char *_buff, size_t _size);
+void fcd_watches_drop(struct FCD_WATCHES *_watches, int _wd);
+void fcd_watches_drop_tree(struct FCD_WATCHES *_watches, int _fd, const char *_path);
+
+#endif //FICHEDA_TREE_H
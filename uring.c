@@ -0,0 +1,130 @@
+/*
+ *  File Check Daemon - минимальная обёртка io_uring (без liburing)
+ */
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "uring.h"
+
+static int fcd_uring_enter(int _fd, unsigned _to_submit, unsigned _min_complete, unsigned _flags) {
+  return (int)syscall(__NR_io_uring_enter, _fd, _to_submit, _min_complete, _flags, NULL, 0);
+}
+
+/*
+ * int fcd_uring_init( struct FCD_URING *ring, unsigned entries );
+ *
+ * The function fcd_uring_init() creates the ring and maps SQ/CQ into memory.
+ * Returns 0 or errno (ENOSYS/EPERM - io_uring is not available).
+ */
+int fcd_uring_init(struct FCD_URING *_ring, unsigned _entries) {
+  struct io_uring_params params;
+  memset(_ring, 0, sizeof(*_ring));
+  memset(&params, 0, sizeof(params));
+  _ring->fd = (int)syscall(__NR_io_uring_setup, _entries, &params);
+  if (_ring->fd < 0) return errno;
+  _ring->entries = params.sq_entries;
+  _ring->sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  _ring->cq_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    if (_ring->cq_len > _ring->sq_len) _ring->sq_len = _ring->cq_len;
+    _ring->cq_len = _ring->sq_len;
+  }
+  _ring->sq_ptr = mmap(NULL, _ring->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring->fd,
+                       IORING_OFF_SQ_RING);
+  if (_ring->sq_ptr == MAP_FAILED) goto failed;
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    _ring->cq_ptr = _ring->sq_ptr;
+  } else {
+    _ring->cq_ptr = mmap(NULL, _ring->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring->fd,
+                         IORING_OFF_CQ_RING);
+    if (_ring->cq_ptr == MAP_FAILED) goto failed;
+  }
+  _ring->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+  _ring->sqes = mmap(NULL, _ring->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring->fd,
+                     IORING_OFF_SQES);
+  if (_ring->sqes == MAP_FAILED) goto failed;
+  _ring->sq_head = (unsigned *)((char *)_ring->sq_ptr + params.sq_off.head);
+  _ring->sq_tail = (unsigned *)((char *)_ring->sq_ptr + params.sq_off.tail);
+  _ring->sq_mask = (unsigned *)((char *)_ring->sq_ptr + params.sq_off.ring_mask);
+  _ring->sq_array = (unsigned *)((char *)_ring->sq_ptr + params.sq_off.array);
+  _ring->cq_head = (unsigned *)((char *)_ring->cq_ptr + params.cq_off.head);
+  _ring->cq_tail = (unsigned *)((char *)_ring->cq_ptr + params.cq_off.tail);
+  _ring->cq_mask = (unsigned *)((char *)_ring->cq_ptr + params.cq_off.ring_mask);
+  _ring->cqes = (struct io_uring_cqe *)((char *)_ring->cq_ptr + params.cq_off.cqes);
+  return 0;
+failed:;
+  int cc = errno;
+  if (_ring->sqes == MAP_FAILED) _ring->sqes = NULL;
+  if (_ring->cq_ptr == MAP_FAILED) _ring->cq_ptr = NULL;
+  if (_ring->sq_ptr == MAP_FAILED) _ring->sq_ptr = NULL;
+  fcd_uring_free(_ring);
+  return cc;
+}
+
+void fcd_uring_free(struct FCD_URING *_ring) {
+  if (_ring->sqes) munmap(_ring->sqes, _ring->sqes_len);
+  if (_ring->cq_ptr && _ring->cq_ptr != _ring->sq_ptr) munmap(_ring->cq_ptr, _ring->cq_len);
+  if (_ring->sq_ptr) munmap(_ring->sq_ptr, _ring->sq_len);
+  if (_ring->fd >= 0) close(_ring->fd);
+  memset(_ring, 0, sizeof(*_ring));
+  _ring->fd = -1;
+}
+
+//  pinned buffers for IORING_OP_READ_FIXED
+int fcd_uring_register(struct FCD_URING *_ring, const struct iovec *_iov, unsigned _count) {
+  if (syscall(__NR_io_uring_register, _ring->fd, IORING_REGISTER_BUFFERS, _iov, _count)) return errno;
+  return 0;
+}
+
+int fcd_uring_unregister(struct FCD_URING *_ring) {
+  if (syscall(__NR_io_uring_register, _ring->fd, IORING_UNREGISTER_BUFFERS, NULL, 0)) return errno;
+  return 0;
+}
+
+//  queue one read (buf_index < 0 - not registered buffer), submitted by the next fcd_uring_wait()
+int fcd_uring_read(struct FCD_URING *_ring, int _fd, void *_buf, unsigned _len, off_t _pos, int _buf_index,
+                   uint64_t _user_data) {
+  unsigned tail = *_ring->sq_tail;
+  if (tail - __atomic_load_n(_ring->sq_head, __ATOMIC_ACQUIRE) >= _ring->entries) return EBUSY;
+  unsigned index = tail & *_ring->sq_mask;
+  struct io_uring_sqe *sqe = &_ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = _buf_index < 0 ? IORING_OP_READ : IORING_OP_READ_FIXED;
+  sqe->fd = _fd;
+  sqe->addr = (uint64_t)(uintptr_t)_buf;
+  sqe->len = _len;
+  sqe->off = _pos;
+  if (_buf_index >= 0) sqe->buf_index = _buf_index;
+  sqe->user_data = _user_data;
+  _ring->sq_array[index] = index;
+  __atomic_store_n(_ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+  ++_ring->to_submit;
+  return 0;
+}
+
+/*
+ * int fcd_uring_wait( struct FCD_URING *ring, uint64_t *user_data, int *res );
+ *
+ * The function fcd_uring_wait() submits the queued reads and takes one
+ * completion (waits if there is none). Returns 0 or errno of io_uring_enter().
+ */
+int fcd_uring_wait(struct FCD_URING *_ring, uint64_t *_user_data, int *_res) {
+  unsigned head;
+  while (1) {
+    head = *_ring->cq_head;
+    if (head != __atomic_load_n(_ring->cq_tail, __ATOMIC_ACQUIRE) && !_ring->to_submit) break;
+    int rc = fcd_uring_enter(_ring->fd, _ring->to_submit, head == *_ring->cq_tail ? 1 : 0, IORING_ENTER_GETEVENTS);
+    if (rc < 0) {
+      if (errno == EINTR) continue;
+      return errno;
+    }
+    _ring->to_submit -= rc;
+  }
+  struct io_uring_cqe *cqe = &_ring->cqes[head & *_ring->cq_mask];
+  *_user_data = cqe->user_data;
+  *_res = cqe->res;
+  __atomic_store_n(_ring->cq_head, head + 1, __ATOMIC_RELEASE);
+  return 0;
+}
@@ -0,0 +1,45 @@
+/*
+ *  File Check Daemon - минимальная обёртка io_uring (без liburing)
+ *
+ *  Кольца SQ/CQ отображаются из ядра через mmap(), системные вызовы
+ *  io_uring_setup/io_uring_enter/io_uring_register вызываются через syscall().
+ *  Кольцо однопоточное: им пользуется только поток, который его создал.
+ */
+#ifndef FICHEDA_URING_H
+#define FICHEDA_URING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+struct FCD_URING {
+    int fd;
+    unsigned entries;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+    void *sq_ptr;
+    size_t sq_len;
+    void *cq_ptr;
+    size_t cq_len;
+    size_t sqes_len;
+    unsigned to_submit;
+};
+
+int fcd_uring_init(struct FCD_URING *_ring, unsigned _entries);
+void fcd_uring_free(struct FCD_URING *_ring);
+int fcd_uring_register(struct FCD_URING *_ring, const struct iovec *_iov, unsigned _count);
+int fcd_uring_unregister(struct FCD_URING *_ring);
+int fcd_uring_read(struct FCD_URING *_ring, int _fd, void *_buf, unsigned _len, off_t _pos, int _buf_index,
+                   uint64_t _user_data);
+int fcd_uring_wait(struct FCD_URING *_ring, uint64_t *_user_data, int *_res);
+
+#endif //FICHEDA_URING_H
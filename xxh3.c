@@ -0,0 +1,227 @@
+/*
+ *  File Check Daemon - XXH3-64
+ *
+ *  Длинный вход (> 240 байт) идёт полосами по 64 байта в 8 аккумуляторов,
+ *  после каждых 16 полос (блок 1 КиБ) аккумуляторы перемешиваются. Последняя
+ *  полоса (с последним байтом входа) считается отдельно, поэтому в буфере
+ *  всегда остаётся хотя бы один байт до xxh3_final(). Короткий вход
+ *  (<= 240 байт) целиком лежит в буфере и считается своими ветками.
+ */
+#include <string.h>
+#include "xxh3.h"
+
+#define XXH_PRIME32_1         0x9E3779B1u
+#define XXH_PRIME32_2         0x85EBCA77u
+#define XXH_PRIME32_3         0xC2B2AE3Du
+#define XXH_PRIME64_1         0x9E3779B185EBCA87ull
+#define XXH_PRIME64_2         0xC2B2AE3D27D4EB4Full
+#define XXH_PRIME64_3         0x165667B19E3779F9ull
+#define XXH_PRIME64_4         0x85EBCA77C2B2AE63ull
+#define XXH_PRIME64_5         0x27D4EB2F165667C5ull
+#define XXH_PRIME_MX1         0x165667919E3779F9ull
+#define XXH_PRIME_MX2         0x9FB21C651E98DF25ull
+
+#define XXH3_SECRET_SIZE      192
+#define XXH3_STRIPES_BLOCK    ((XXH3_SECRET_SIZE - XXH3_STRIPE_LEN) / 8)
+#define XXH3_MIDSIZE_MAX      240
+
+static const unsigned char xxh3_secret[XXH3_SECRET_SIZE] = {
+  0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+  0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+  0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+  0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+  0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+  0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+  0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+  0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+  0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+  0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+  0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+  0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e
+};
+
+static inline uint64_t xxh_read64(const void *_p) {
+  uint64_t v;
+  memcpy(&v, _p, sizeof(v));
+  return v;
+}
+
+static inline uint32_t xxh_read32(const void *_p) {
+  uint32_t v;
+  memcpy(&v, _p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t xxh_rotl64(uint64_t _x, int _r) {
+  return (_x << _r) | (_x >> (64 - _r));
+}
+
+static inline uint64_t xxh_mul128_fold64(uint64_t _a, uint64_t _b) {
+  unsigned __int128 p = (unsigned __int128)_a * _b;
+  return (uint64_t)p ^ (uint64_t)(p >> 64);
+}
+
+static uint64_t xxh64_avalanche(uint64_t _h) {
+  _h ^= _h >> 33;
+  _h *= XXH_PRIME64_2;
+  _h ^= _h >> 29;
+  _h *= XXH_PRIME64_3;
+  return _h ^ (_h >> 32);
+}
+
+static uint64_t xxh3_avalanche(uint64_t _h) {
+  _h ^= _h >> 37;
+  _h *= XXH_PRIME_MX1;
+  return _h ^ (_h >> 32);
+}
+
+static uint64_t xxh3_rrmxmx(uint64_t _h, uint64_t _len) {
+  _h ^= xxh_rotl64(_h, 49) ^ xxh_rotl64(_h, 24);
+  _h *= XXH_PRIME_MX2;
+  _h ^= (_h >> 35) + _len;
+  _h *= XXH_PRIME_MX2;
+  return _h ^ (_h >> 28);
+}
+
+static uint64_t xxh3_mix16(const unsigned char *_in, const unsigned char *_secret) {
+  return xxh_mul128_fold64(xxh_read64(_in) ^ xxh_read64(_secret), xxh_read64(_in + 8) ^ xxh_read64(_secret + 8));
+}
+
+//  0..240 bytes
+static uint64_t xxh3_short(const unsigned char *_in, size_t _len) {
+  const unsigned char *secret = xxh3_secret;
+  if (_len == 0) return xxh64_avalanche(xxh_read64(secret + 56) ^ xxh_read64(secret + 64));
+  if (_len <= 3) {
+    uint32_t combined = ((uint32_t)_in[0] << 16) | ((uint32_t)_in[_len >> 1] << 24) | _in[_len - 1] |
+                        ((uint32_t)_len << 8);
+    return xxh64_avalanche(combined ^ (uint64_t)(xxh_read32(secret) ^ xxh_read32(secret + 4)));
+  }
+  if (_len <= 8) {
+    uint64_t input64 = xxh_read32(_in + _len - 4) + ((uint64_t)xxh_read32(_in) << 32);
+    return xxh3_rrmxmx(input64 ^ (xxh_read64(secret + 8) ^ xxh_read64(secret + 16)), _len);
+  }
+  if (_len <= 16) {
+    uint64_t lo = xxh_read64(_in) ^ (xxh_read64(secret + 24) ^ xxh_read64(secret + 32));
+    uint64_t hi = xxh_read64(_in + _len - 8) ^ (xxh_read64(secret + 40) ^ xxh_read64(secret + 48));
+    return xxh3_avalanche(_len + __builtin_bswap64(lo) + hi + xxh_mul128_fold64(lo, hi));
+  }
+  uint64_t acc = _len * XXH_PRIME64_1;
+  if (_len <= 128) {
+    if (_len > 32) {
+      if (_len > 64) {
+        if (_len > 96) {
+          acc += xxh3_mix16(_in + 48, secret + 96);
+          acc += xxh3_mix16(_in + _len - 64, secret + 112);
+        }
+        acc += xxh3_mix16(_in + 32, secret + 64);
+        acc += xxh3_mix16(_in + _len - 48, secret + 80);
+      }
+      acc += xxh3_mix16(_in + 16, secret + 32);
+      acc += xxh3_mix16(_in + _len - 32, secret + 48);
+    }
+    acc += xxh3_mix16(_in, secret);
+    acc += xxh3_mix16(_in + _len - 16, secret + 16);
+    return xxh3_avalanche(acc);
+  }
+  //  129..240
+  int rounds = _len / 16;
+  for (int i = 0; i < 8; ++i) acc += xxh3_mix16(_in + 16 * i, secret + 16 * i);
+  acc = xxh3_avalanche(acc);
+  for (int i = 8; i < rounds; ++i) acc += xxh3_mix16(_in + 16 * i, secret + 16 * (i - 8) + 3);
+  acc += xxh3_mix16(_in + _len - 16, secret + 136 - 17);
+  return xxh3_avalanche(acc);
+}
+
+static void xxh3_accumulate512(uint64_t *_acc, const unsigned char *_in, const unsigned char *_secret) {
+  for (int i = 0; i < 8; ++i) {
+    uint64_t data = xxh_read64(_in + 8 * i);
+    uint64_t key = data ^ xxh_read64(_secret + 8 * i);
+    _acc[i ^ 1] += data;
+    _acc[i] += (uint64_t)(uint32_t)key * (key >> 32);
+  }
+}
+
+static void xxh3_scramble(uint64_t *_acc) {
+  const unsigned char *secret = xxh3_secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN;
+  for (int i = 0; i < 8; ++i) {
+    uint64_t a = _acc[i];
+    a ^= a >> 47;
+    a ^= xxh_read64(secret + 8 * i);
+    _acc[i] = a * XXH_PRIME32_1;
+  }
+}
+
+//  one stripe that is not the last one of the input
+static void xxh3_stripe(uint64_t *_acc, size_t *_stripes, const unsigned char *_in) {
+  xxh3_accumulate512(_acc, _in, xxh3_secret + *_stripes * 8);
+  if (++*_stripes == XXH3_STRIPES_BLOCK) {
+    xxh3_scramble(_acc);
+    *_stripes = 0;
+  }
+}
+
+void xxh3_init(struct XXH3_STATE *_state) {
+  static const uint64_t acc[8] = {
+    XXH_PRIME32_3, XXH_PRIME64_1, XXH_PRIME64_2, XXH_PRIME64_3,
+    XXH_PRIME64_4, XXH_PRIME32_2, XXH_PRIME64_5, XXH_PRIME32_1
+  };
+  memcpy(_state->acc, acc, sizeof(acc));
+  _state->buffered = 0;
+  _state->stripes = 0;
+  _state->total = 0;
+}
+
+void xxh3_update(struct XXH3_STATE *_state, const void *_buf, size_t _len) {
+  const unsigned char *in = _buf;
+  _state->total += _len;
+  if (_len <= XXH3_BUFFER_SIZE - _state->buffered) {
+    memcpy(_state->buffer + _state->buffered, in, _len);
+    _state->buffered += _len;
+    return;
+  }
+  //  more input follows, so the whole buffer goes
+  if (_state->buffered) {
+    size_t fill = XXH3_BUFFER_SIZE - _state->buffered;
+    memcpy(_state->buffer + _state->buffered, in, fill);
+    in += fill;
+    _len -= fill;
+    for (size_t i = 0; i < XXH3_BUFFER_SIZE; i += XXH3_STRIPE_LEN) xxh3_stripe(_state->acc, &_state->stripes, _state->buffer + i);
+    _state->buffered = 0;
+  }
+  //  straight from the input, at least one byte is left for the buffer
+  if (_len > XXH3_BUFFER_SIZE) {
+    for (; _len > XXH3_BUFFER_SIZE; in += XXH3_STRIPE_LEN, _len -= XXH3_STRIPE_LEN)
+      xxh3_stripe(_state->acc, &_state->stripes, in);
+    //  the last consumed stripe, for a short tail in xxh3_final()
+    memcpy(_state->buffer + XXH3_BUFFER_SIZE - XXH3_STRIPE_LEN, in - XXH3_STRIPE_LEN, XXH3_STRIPE_LEN);
+  }
+  memcpy(_state->buffer, in, _len);
+  _state->buffered = _len;
+}
+
+uint64_t xxh3_final(const struct XXH3_STATE *_state) {
+  uint64_t acc[8];
+  size_t stripes = _state->stripes;
+  unsigned char last[XXH3_STRIPE_LEN];
+  const unsigned char *tail;
+  if (_state->total <= XXH3_MIDSIZE_MAX) return xxh3_short(_state->buffer, _state->total);
+  memcpy(acc, _state->acc, sizeof(acc));
+  if (_state->buffered >= XXH3_STRIPE_LEN) {
+    size_t n = (_state->buffered - 1) / XXH3_STRIPE_LEN;
+    for (size_t i = 0; i < n; ++i) xxh3_stripe(acc, &stripes, _state->buffer + i * XXH3_STRIPE_LEN);
+    tail = _state->buffer + _state->buffered - XXH3_STRIPE_LEN;
+  } else {
+    //  the last stripe overlaps the previous one
+    size_t catchup = XXH3_STRIPE_LEN - _state->buffered;
+    memcpy(last, _state->buffer + XXH3_BUFFER_SIZE - catchup, catchup);
+    memcpy(last + catchup, _state->buffer, _state->buffered);
+    tail = last;
+  }
+  xxh3_accumulate512(acc, tail, xxh3_secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN - 7);
+  //  merge accumulators
+  uint64_t result = _state->total * XXH_PRIME64_1;
+  for (int i = 0; i < 4; ++i)
+    result += xxh_mul128_fold64(acc[2 * i] ^ xxh_read64(xxh3_secret + 11 + 16 * i),
+                                acc[2 * i + 1] ^ xxh_read64(xxh3_secret + 11 + 16 * i + 8));
+  return xxh3_avalanche(result);
+}
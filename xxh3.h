@@ -0,0 +1,28 @@
+/*
+ *  File Check Daemon - XXH3-64 (xxHash3, seed 0, секрет по умолчанию)
+ *
+ *  Потоковый расчёт: результат совпадает с XXH3_64bits() из xxhash.h при любом
+ *  разбиении входа на блоки. Не криптографический - только для скорости.
+ */
+#ifndef FICHEDA_XXH3_H
+#define FICHEDA_XXH3_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define XXH3_STRIPE_LEN       64
+#define XXH3_BUFFER_SIZE      256
+
+struct XXH3_STATE {
+    uint64_t acc[8];
+    unsigned char buffer[XXH3_BUFFER_SIZE];
+    size_t buffered;
+    size_t stripes;
+    uint64_t total;
+};
+
+void xxh3_init(struct XXH3_STATE *_state);
+void xxh3_update(struct XXH3_STATE *_state, const void *_buf, size_t _len);
+uint64_t xxh3_final(const struct XXH3_STATE *_state);
+
+#endif //FICHEDA_XXH3_H